@@ -1,243 +1,425 @@
 #include "BigInt.h"
+#include "BigIntImpl.h"
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+	// magnitudes of at most two limbs are handled in native 64-bit arithmetic
+	const size_t DLIMB_LIMBS = 2;
+
+	BigInt::dlimb_t Load64(const BigIntLimbs& x)
+	{
+		BigInt::dlimb_t value = 0;
+		for (size_t i = x.size(); i-- > 0;)
+			value = (value << BigInt::LIMB_BITS) | x[i];
+		return value;
+	}
+
+
+	// stores a normalized value, stays in the inline storage
+	void Store64(BigIntLimbs& x, BigInt::dlimb_t value)
+	{
+		x.clear();
+		for (; value != 0; value >>= BigInt::LIMB_BITS)
+			x.push_back(static_cast<BigInt::limb_t>(value));
+	}
+
+
+	// magnitudes in the inline limbs are added, subtracted and compared as two 64-bit
+	// halves, which needs no 128-bit integer type
+	static_assert(BigIntLimbs::INLINE_LIMBS == 4, "the small paths keep the inline limbs in two halves");
+
+	struct Value128
+	{
+		BigInt::dlimb_t low;
+		BigInt::dlimb_t high;
+	};
+
+
+	Value128 Load128(const BigIntLimbs& x)
+	{
+		BigInt::limb_t v[BigIntLimbs::INLINE_LIMBS] = {};
+		std::copy(x.begin(), x.end(), v);
+		return { (BigInt::dlimb_t(v[1]) << BigInt::LIMB_BITS) | v[0], (BigInt::dlimb_t(v[3]) << BigInt::LIMB_BITS) | v[2] };
+	}
+
+
+	// stores a normalized value, stays in the inline storage
+	void Store128(BigIntLimbs& x, Value128 value)
+	{
+		BigInt::limb_t v[BigIntLimbs::INLINE_LIMBS] = {
+			static_cast<BigInt::limb_t>(value.low), static_cast<BigInt::limb_t>(value.low >> BigInt::LIMB_BITS),
+			static_cast<BigInt::limb_t>(value.high), static_cast<BigInt::limb_t>(value.high >> BigInt::LIMB_BITS) };
+		size_t n = BigIntLimbs::INLINE_LIMBS;
+		while (n > 0 && v[n - 1] == 0)
+			--n;
+		x.assign(v, v + n);
+	}
+
+
+	Value128 Sub128(Value128 a, Value128 b)  // a - b for a >= b
+	{
+		return { a.low - b.low, a.high - b.high - ((a.low < b.low) ? 1 : 0) };
+	}
+
+
+	void CheckBase(int base)
+	{
+		if (base < 2 || base > 36)
+			throw std::invalid_argument("BigInt: base " + std::to_string(base) + " is not in 2..36");
+	}
+
+
+	// stream word of the BigIntNoParens manipulator, non-zero drops the parentheses
+	int ParensIndex()
+	{
+		static const int index = std::ios_base::xalloc();
+		return index;
+	}
+
+
+	// the limbs of a sign and magnitude as infinite two's complement, ~(|x| - 1) for negative x,
+	// read from the low end; the borrow of the - 1 runs through the low zero limbs
+	class TwosComplementReader
+	{
+	public:
+		TwosComplementReader(const BigIntLimbs& limbs, bool negative) :
+			m_limbs(limbs), m_borrow(negative ? 1 : 0), m_negative(negative)
+		{}
+
+		BigInt::limb_t Next(size_t i)
+		{
+			BigInt::limb_t limb = (i < m_limbs.size()) ? m_limbs[i] : 0;
+			if (!m_negative)
+				return limb;
+			BigInt::limb_t d = limb - m_borrow;
+			m_borrow = (limb < m_borrow) ? 1 : 0;
+			return ~d;
+		}
+
+	private:
+		const BigIntLimbs& m_limbs;
+		BigInt::limb_t m_borrow;
+		bool m_negative;
+	};
+
+
+	// limb-wise op on two values as two's complement in one pass; the sign of the result is
+	// op applied to the sign extensions, a negative result is turned back by ~r + 1 on the way
+	template<typename Op>
+	void Bitwise(BigIntLimbs& r, bool& r_negative, const BigIntLimbs& a, bool a_negative, const BigIntLimbs& b, bool b_negative, Op op)
+	{
+		const BigInt::limb_t ones = ~BigInt::limb_t(0);
+		bool negative = op(a_negative ? ones : 0, b_negative ? ones : 0) != 0;
+		size_t n = std::max(a.size(), b.size()) + 1;  // room for the carry of ~r + 1
+		BigIntLimbs result;
+		result.resize(n);
+		TwosComplementReader x(a, a_negative);
+		TwosComplementReader y(b, b_negative);
+		BigInt::limb_t carry = 1;
+		for (size_t i = 0; i < n; ++i)
+		{
+			BigInt::limb_t limb = op(x.Next(i), y.Next(i));
+			if (negative)
+			{
+				limb = ~limb + carry;
+				carry = (carry != 0 && limb == 0) ? 1 : 0;
+			}
+			result[i] = limb;
+		}
+		result.resize(bigint_impl::Normalized(result.data(), n));
+		r.swap(result);
+		r_negative = negative && !r.empty();
+	}
+}
 
 
 BigInt::BigInt() :
-	m_str("0"),
 	m_sign(false)
 {}
 
 
-BigInt::BigInt(const std::string& view_str)
+BigInt::BigInt(const std::string& view_str) :
+	BigInt(view_str.data(), view_str.size())
+{}
+
+
+BigInt::BigInt(const char* text, size_t size)
 {
-	char c = view_str[0];
-	if (c == '-' || c == '+')
+	// [+-]digits, nothing else; the message quotes the start of a possibly huge text
+	auto quoted = [=] { return "\"" + std::string(text, std::min<size_t>(size, 64)) + (size > 64 ? "...\"" : "\""); };
+	size_t pos = 0;
+	if (size > 0 && (text[0] == '-' || text[0] == '+'))
 	{
-		m_sign = (c == '-' && view_str[1] != '0') ? true : false;
-		m_str = ReverseStr(view_str.substr(1));
+		m_sign = (text[0] == '-');
+		pos = 1;
 	}
-	else
+	if (pos == size)
+		throw std::invalid_argument("BigInt: no digits in " + quoted());
+	for (size_t i = pos; i < size; ++i)
 	{
-		m_str = ReverseStr(view_str);
+		if (text[i] < '0' || text[i] > '9')
+			throw std::invalid_argument("BigInt: not a decimal number " + quoted());
 	}
+	bigint_impl::ParseDecimal(m_limbs, text + pos, size - pos);
+	Normalize();
 }
 
 
 BigInt::BigInt(const int& i) :
-	BigInt(std::to_string(i))
-{}
+	m_sign(i < 0)
+{
+	static_assert(sizeof(int) <= sizeof(limb_t), "int must fit in one limb");
+	// negate in unsigned arithmetic: -INT_MIN overflows int
+	limb_t abs_value = (i < 0) ? 0u - static_cast<limb_t>(i) : static_cast<limb_t>(i);
+	if (abs_value != 0)
+		m_limbs.push_back(abs_value);
+}
 
 
 BigInt::BigInt(const BigInt& other) :
-	m_str(other.GetStr()),
+	m_limbs(other.GetLimbs()),
 	m_sign(other.GetSign())
 {}
 
 
+BigInt::BigInt(BigInt&& other) noexcept :
+	m_limbs(std::move(other.m_limbs)),
+	m_sign(other.m_sign)
+{
+	other.m_limbs.clear();
+	other.m_sign = false;
+}
+
+
 BigInt& BigInt::operator=(const BigInt& other)
 {
 	if (this == &other)
 		return *this;
 
-	m_str = other.GetStr();
+	m_limbs = other.GetLimbs();
 	m_sign = other.GetSign();
 	return *this;
 }
 
 
-std::string BigInt::ReverseStr(const std::string& s) const
+BigInt& BigInt::operator=(BigInt&& other) noexcept
 {
-	std::string tmp(s.rbegin(), s.rend());
-	return tmp;
+	if (this == &other)
+		return *this;
+
+	m_limbs.swap(other.m_limbs);
+	m_sign = other.m_sign;
+	other.m_limbs.clear();  // keeps the capacity for reuse
+	other.m_sign = false;
+	return *this;
 }
 
 
 std::string BigInt::GetViewStr() const
 {
-	std::string tmp;
+	std::string s;
 	if (GetSign())
-		tmp.push_back('-');
-	tmp += ReverseStr(m_str);
-	return tmp;
+		s.push_back('-');
+	bigint_impl::AppendDecimal(s, m_limbs.data(), m_limbs.size());
+	return s;
 }
 
 
-std::ostream& operator<<(std::ostream& stream, const BigInt& x)
+std::to_chars_result BigInt::ToChars(char* first, char* last, int base) const
+{
+	CheckBase(base);
+	char* pos = first;
+	if (GetSign())
+	{
+		if (pos == last)
+			return { last, std::errc::value_too_large };
+		*pos++ = '-';
+	}
+	char* end = bigint_impl::WriteChars(pos, last, m_limbs.data(), m_limbs.size(), static_cast<unsigned>(base));
+	if (end == nullptr)
+		return { last, std::errc::value_too_large };
+	return { end, std::errc() };
+}
+
+
+std::from_chars_result BigInt::FromChars(const char* first, const char* last, BigInt& value, int base)
+{
+	CheckBase(base);
+	const char* pos = first;
+	bool negative = (pos != last && *pos == '-');
+	if (negative)
+		++pos;
+	size_t n = bigint_impl::CountDigits(pos, last, static_cast<unsigned>(base));
+	if (n == 0)
+		return { first, std::errc::invalid_argument };
+	bigint_impl::ParseChars(value.m_limbs, pos, n, static_cast<unsigned>(base));
+	value.m_sign = negative;
+	value.Normalize();
+	return { pos + n, std::errc() };
+}
+
+
+size_t BigInt::DigitCountUpperBound(int base) const
+{
+	CheckBase(base);
+	return bigint_impl::DigitsUpperBound(BitLength(), static_cast<unsigned>(base)) + (GetSign() ? 1 : 0);
+}
+
+
+size_t BigInt::GetNumDigits() const
+{
+	std::string s = GetViewStr();
+	return GetSign() ? s.size() - 1 : s.size();
+}
+
+
+void BigInt::WriteDecimal(const std::function<void(const char*, size_t)>& sink) const
+{
+	if (GetSign())
+		sink("-", 1);
+	bigint_impl::WriteDecimal(m_limbs.data(), m_limbs.size(), sink);
+}
+
+
+std::ostream& BigIntNoParens(std::ostream& stream)
 {
-	stream << "(" << x.GetViewStr() << ")";
+	stream.iword(ParensIndex()) = 1;
 	return stream;
 }
 
 
-BigInt& BigInt::operator+=(const BigInt& other)
+std::ostream& BigIntParens(std::ostream& stream)
 {
-	auto size1 = GetNumDigits();
-	auto size2 = other.GetNumDigits();
-	auto max_size = std::max(size1, size2);
-	const std::string& str2 = other.GetStr();
+	stream.iword(ParensIndex()) = 0;
+	return stream;
+}
 
-	bool sign1 = GetSign();
-	bool sign2 = other.GetSign();
 
-	// a >= 0 && b >= 0
-	// a < 0 && b < 0
-	if (sign1 == sign2)
+std::ostream& operator<<(std::ostream& stream, const BigInt& x)
+{
+	bool parens = (stream.iword(ParensIndex()) == 0);
+	if (parens)
+		stream << '(';
+	x.WriteDecimal([&stream](const char* chars, size_t n) { stream.write(chars, static_cast<std::streamsize>(n)); });
+	if (parens)
+		stream << ')';
+	return stream;
+}
+
+
+std::istream& operator>>(std::istream& stream, BigInt& x)
+{
+	std::istream::sentry sentry(stream);  // skips whitespace
+	if (!sentry)
+		return stream;
+	std::streambuf& in = *stream.rdbuf();
+	bool negative = false;
+	int c = in.sgetc();
+	if (c == '-' || c == '+')
 	{
-		int carry = 0;
-		for (int i = 0; i < max_size; ++i)
-		{
-			int d1 = (i < size1) ? (m_str[i] - '0') : 0;
-			int d2 = (i < size2) ? (str2[i] - '0') : 0;
-			int sum = d1 + d2 + carry;
-			int digit = sum % 10;
-			carry = sum / 10;
-
-			char c = '0' + digit;
-			if (i < size1)
-			{
-				m_str[i] = c;
-			}
-			else
-			{
-				m_str.push_back(c);
-			}
-			// early stopping
-			if (carry == 0 && (size1 > size2 && i > size2))
-			{
-				break;
-			}
-		}
-		if (carry > 0)
-			m_str.push_back('0' + carry);
+		negative = (c == '-');
+		in.sbumpc();
+	}
+	BigIntLimbs limbs;
+	size_t digits = bigint_impl::ReadDecimal(limbs, in);
+	std::ios_base::iostate state = std::ios_base::goodbit;
+	if (in.sgetc() == std::char_traits<char>::eof())
+		state |= std::ios_base::eofbit;
+	if (digits == 0)
+	{
+		state |= std::ios_base::failbit;
 	}
 	else
 	{
-		// a >= 0, b < 0 : a += -|b| <-> a -= |b|
-		if (!sign1 && sign2)
-		{
-			*this -= -other;
-		}
-		// a < 0, b >= 0 : -|a| += b <-> a = b - |a|
-		if (sign1 && !sign2)
-		{
-			BigInt tmp = *this;
-			*this = other;
-			*this -= -tmp;
-		}
+		x.m_limbs.swap(limbs);
+		x.m_sign = negative;
+		x.Normalize();
 	}
+	stream.setstate(state);
+	return stream;
+}
+
+
+BigInt& BigInt::operator+=(const BigInt& other)
+{
+	AddSigned(other, false);
 	return *this;
 }
 
 
 BigInt& BigInt::operator-=(const BigInt& other)
 {
-	if (*this == other)
-	{
-		*this = BigInt("0");
-		return *this;
-	}
+	AddSigned(other, true);
+	return *this;
+}
 
-	auto size1 = GetNumDigits();
-	auto size2 = other.GetNumDigits();
-	auto max_size = std::max(size1, size2);
-	const std::string& str2 = other.GetStr();
 
+void BigInt::AddSigned(const BigInt& other, bool negate_other)
+{
 	bool sign1 = GetSign();
-	bool sign2 = other.GetSign();
+	bool sign2 = (other.GetSign() != negate_other);
 
-	// + +
-	if (!(sign1 || sign2))
-	{
-		if (*this > other)
-		{
-			int borrow = 0;
-			for (int i = 0; i < max_size; ++i)
-			{
-				int d1 = (i < size1) ? (m_str[i] - '0') : 0;
-				int d2 = (i < size2) ? (str2[i] - '0') : 0;
-				int sub = d1 - d2 - borrow;
-				int digit = (sub < 0) ? sub + 10 : sub;
-				borrow = (sub < 0) ? 1 : 0;
-				char c = '0' + digit;
-				m_str[i] = c;
-			}
-			RemoveHeadingZeroes();
-		}
-		else
-		{
-			// 12 - 12345 = -(12345 - 12)
-			BigInt tmp = *this;
-			*this = other;
-			*this -= tmp;
-			Negate();
-		}
-	}
-	// - -
-	else if (sign1 && sign2)
+	// a >= 0 && b >= 0
+	// a < 0 && b < 0
+	if (sign1 == sign2 || other.IsZero())
 	{
-		// -12 -= (-12345) <-> -12 += 12345  <-> 12345 -= 12
-		if (*this > other)
-		{
-			Negate();
-			BigInt tmp = *this;
-			*this = other;
-			Negate();
-			*this -= tmp;
-		}
-		// -12345 -= (-12) <-> -12345 += 12
-		else
-		{
-			Negate();
-			*this -= -other;
-			Negate();
-		}
+		AddAbs(other);
+		return;
 	}
-	// + -
-	else if (!sign1 && sign2)
+	// signs differ: the larger magnitude wins the sign
+	// 12345 + (-12) = 12345 - 12, -12345 + 12 = -(12345 - 12)
+	if (CompareAbs(*this, other) >= 0)
 	{
-		*this += -other;
+		SubAbs(other);
 	}
-	// - +
+	// 12 + (-12345) = -(12345 - 12), -12 + 12345 = 12345 - 12
 	else
 	{
-		// -12345 -= 12
-		Negate();
-		*this += other;
-		Negate();
+		SubAbsFrom(other);
+		m_sign = sign2;
 	}
-
-	return *this;
 }
 
 
 BigInt& BigInt::operator*=(const BigInt& other)
 {
-	auto size1 = GetNumDigits();
-	auto size2 = other.GetNumDigits();
-	auto max_size = std::max(size1, size2);
-	const std::string& str2 = other.GetStr();
-
 	bool sign1 = GetSign();
 	bool sign2 = other.GetSign();
 
-	if (size2 == 1)
+	if (IsZero() || other.IsZero())
 	{
-		MulByOneDigitNumber(other.GetStr()[0] - '0');
-		m_sign = (sign1 != sign2);
+		*this = BigInt();
+		return *this;
+	}
+	if (other.GetNumLimbs() == 1)
+	{
+		MulWord(other.GetLimbs()[0], sign2);
 		return *this;
 	}
-	// calc partial multiplies for every digit in "other" and sum them
-	BigInt sum(0);
-	for (int i = 0; i < size2; ++i)
+	const BigIntLimbs& b = other.GetLimbs();
+	size_t size = m_limbs.size() + b.size();
+	if (size <= 2 * BigIntLimbs::INLINE_LIMBS)
 	{
-		BigInt tmp = *this;
-		tmp.MulByOneDigitNumber(str2[i] - '0');
-		tmp.MulByTen(i);
-		sum += tmp;
+		// small operands: product on the stack, no temporary buffer
+		limb_t result[2 * BigIntLimbs::INLINE_LIMBS];
+		bigint_impl::MulBasecase(result, m_limbs.data(), m_limbs.size(), b.data(), b.size());
+		m_limbs.assign(result, result + bigint_impl::Normalized(result, size));
+	}
+	else
+	{
+		// the engine picks schoolbook, Karatsuba or Toom-3 by operand sizes
+		BigIntLimbs result;
+		result.resize(size);
+		bigint_impl::Mul(result.data(), m_limbs.data(), m_limbs.size(), b.data(), b.size());
+		m_limbs.swap(result);
 	}
-	*this = sum;
 	m_sign = (sign1 != sign2);  // logical XOR
+	Normalize();
 
 	return *this;
 }
@@ -258,8 +440,7 @@ BigInt& BigInt::operator%=(const BigInt& other)
 
 BigInt& BigInt::operator++()
 {
-	static const BigInt one("1");
-	*this += one;
+	AddWord(1, false);
 	return *this;
 }
 
@@ -272,8 +453,7 @@ BigInt BigInt::operator++(int)
 
 BigInt& BigInt::operator--()
 {
-	static const BigInt one("1");
-	*this -= one;
+	AddWord(1, true);
 	return *this;
 }
 
@@ -287,18 +467,39 @@ BigInt BigInt::operator--(int)
 
 void BigInt::Negate()
 {
-	m_sign = !m_sign;
+	if (!IsZero())
+		m_sign = !m_sign;
+}
+
+
+void BigInt::AddMul(const BigInt& a, const BigInt& b)
+{
+	MulAccumulate(a, b, false);
 }
 
 
-const BigInt BigInt::operator-() const
+void BigInt::SubMul(const BigInt& a, const BigInt& b)
+{
+	MulAccumulate(a, b, true);
+}
+
+
+BigInt BigInt::operator-() const &
 {
 	BigInt tmp(*this);
 	tmp.Negate();
-	return std::move(tmp);
+	return tmp;
 }
 
-const BigInt BigInt::Abs() const
+
+BigInt BigInt::operator-() &&
+{
+	Negate();
+	return std::move(*this);
+}
+
+
+BigInt BigInt::Abs() const &
 {
 	if (GetSign())
 		return -(*this);
@@ -306,175 +507,612 @@ const BigInt BigInt::Abs() const
 }
 
 
-bool operator<(const BigInt& left, const BigInt& right)
+BigInt BigInt::Abs() &&
+{
+	m_sign = false;
+	return std::move(*this);
+}
+
+
+BigInt BigInt::operator~() const
 {
-	bool sign1 = left.GetSign();
-	bool sign2 = right.GetSign();
-	// left < 0, right > 0
-	if (sign1 && !sign2)
-		return true;
-	// left >= 0, right < 0
-	if (!sign1 && sign2)
-		return false;
-	// signs are equal - compare abs(left) VS abs(right)
-	// first check if number of digits differ
-	auto size1 = left.GetNumDigits();
-	auto size2 = right.GetNumDigits();
-	if (size1 > size2)
-		return sign1;
-	else if (size1 < size2)
-		return !sign1;
+	BigInt tmp(*this);
+	tmp.Negate();
+	tmp.AddWord(1, true);
+	return tmp;
+}
+
+
+BigInt& BigInt::operator&=(const BigInt& other)
+{
+	if (!m_sign && !other.m_sign)
+	{
+		// non-negative operands: no wider than the shorter one, in place
+		size_t n = std::min(m_limbs.size(), other.m_limbs.size());
+		m_limbs.resize(n);
+		for (size_t i = 0; i < n; ++i)
+			m_limbs[i] &= other.m_limbs[i];
+		Normalize();
+		return *this;
+	}
+	Bitwise(m_limbs, m_sign, m_limbs, m_sign, other.m_limbs, other.m_sign, [](limb_t a, limb_t b) { return a & b; });
+	return *this;
+}
+
+
+BigInt& BigInt::operator|=(const BigInt& other)
+{
+	Bitwise(m_limbs, m_sign, m_limbs, m_sign, other.m_limbs, other.m_sign, [](limb_t a, limb_t b) { return a | b; });
+	return *this;
+}
+
+
+BigInt& BigInt::operator^=(const BigInt& other)
+{
+	Bitwise(m_limbs, m_sign, m_limbs, m_sign, other.m_limbs, other.m_sign, [](limb_t a, limb_t b) { return a ^ b; });
+	return *this;
+}
+
+
+BigInt& BigInt::operator<<=(size_t bits)
+{
+	if (IsZero() || bits == 0)
+		return *this;
+	size_t skip = bits / LIMB_BITS;
+	unsigned shift = bits % LIMB_BITS;
+	size_t size = m_limbs.size();
+	m_limbs.resize(size + skip + 1);
+	limb_t* p = m_limbs.data();
+	std::copy_backward(p, p + size, p + skip + size);
+	std::fill(p, p + skip, 0);
+	if (shift != 0)
+		p[skip + size] = bigint_impl::LShift(p + skip, p + skip, size, shift);
+	Normalize();
+	return *this;
+}
+
+
+BigInt& BigInt::operator>>=(size_t bits)
+{
+	size_t skip = bits / LIMB_BITS;
+	unsigned shift = bits % LIMB_BITS;
+	size_t size = m_limbs.size();
+	// floor for negative x: -(|x| >> bits) - 1 when set bits are shifted out
+	bool round_down = false;
+	if (m_sign)
+	{
+		for (size_t i = 0; i < std::min(skip, size) && !round_down; ++i)
+			round_down = (m_limbs[i] != 0);
+		if (skip < size && shift != 0)
+			round_down = round_down || (m_limbs[skip] & ((limb_t(1) << shift) - 1)) != 0;
+	}
+	if (skip >= size)
+	{
+		m_limbs.clear();
+	}
 	else
 	{
-		// signs are equal and number of digits is equal
-		const auto& str1 = left.GetStr();
-		const auto& str2 = right.GetStr();
-		for (int i = size1 - 1; i >= 0; --i)
+		limb_t* p = m_limbs.data();
+		std::copy(p + skip, p + size, p);
+		m_limbs.resize(size - skip);
+		if (shift != 0)
+			bigint_impl::RShift(p, p, size - skip, shift);
+	}
+	bool negative = m_sign;
+	Normalize();
+	if (round_down)
+	{
+		m_sign = negative;
+		AddWord(1, true);
+	}
+	return *this;
+}
+
+
+size_t BigInt::BitLength() const
+{
+	if (IsZero())
+		return 0;
+	return m_limbs.size() * LIMB_BITS - bigint_impl::CountLeadingZeros(m_limbs.back());
+}
+
+
+bool BigInt::TestBit(size_t i) const
+{
+	size_t k = i / LIMB_BITS;
+	if (k >= m_limbs.size())
+		return m_sign;
+	limb_t limb = m_limbs[k];
+	if (m_sign)
+	{
+		// ~(|x| - 1): the borrow reaches limb k only when all limbs below it are zero
+		size_t low = 0;
+		while (m_limbs[low] == 0)
+			++low;
+		if (k < low)
+			return false;
+		limb = (k == low) ? ~(limb - 1) : ~limb;
+	}
+	return ((limb >> (i % LIMB_BITS)) & 1) != 0;
+}
+
+
+size_t BigInt::PopCount() const
+{
+	size_t count = 0;
+	for (limb_t limb : m_limbs)
+		count += bigint_impl::PopCount(limb);
+	return count;
+}
+
+
+size_t BigInt::TrailingZeros() const
+{
+	if (IsZero())
+		return 0;
+	size_t i = 0;
+	while (m_limbs[i] == 0)
+		++i;
+	return i * LIMB_BITS + bigint_impl::CountTrailingZeros(m_limbs[i]);
+}
+
+
+BigIntThresholds& BigInt::Thresholds()
+{
+	static BigIntThresholds thresholds;
+	return thresholds;
+}
+
+
+void BigInt::SetNumThreads(size_t n)
+{
+	bigint_impl::SetNumThreads(n);
+}
+
+
+size_t BigInt::GetNumThreads()
+{
+	return bigint_impl::NumThreads();
+}
+
+
+int BigInt::CompareAbs(const BigInt& a, const BigInt& b)
+{
+	// first check if number of limbs differ
+	auto size1 = a.GetNumLimbs();
+	auto size2 = b.GetNumLimbs();
+	if (size1 != size2)
+		return (size1 < size2) ? -1 : 1;
+	// number of limbs is equal: find the most significant differing limb
+	if (size1 <= BigIntLimbs::INLINE_LIMBS)
+	{
+		Value128 value1 = Load128(a.m_limbs);
+		Value128 value2 = Load128(b.m_limbs);
+		if (value1.high != value2.high)
+			return (value1.high < value2.high) ? -1 : 1;
+		return (value1.low == value2.low) ? 0 : ((value1.low < value2.low) ? -1 : 1);
+	}
+	return bigint_impl::CmpN(a.m_limbs.data(), b.m_limbs.data(), size1);
+}
+
+
+int BigInt::Compare(const BigInt& a, const BigInt& b)
+{
+	// zero is normalized to non-negative, so the signs alone decide when they differ
+	if (a.m_sign != b.m_sign)
+		return a.m_sign ? -1 : 1;
+	int cmp = CompareAbs(a, b);
+	return a.m_sign ? -cmp : cmp;
+}
+
+
+bool operator<(const BigInt& left, const BigInt& right)
+{
+	return BigInt::Compare(left, right) < 0;
+}
+
+
+void BigInt::Normalize()
+{
+	while (!m_limbs.empty() && m_limbs.back() == 0)
+		m_limbs.pop_back();
+	if (m_limbs.empty())
+		m_sign = false;
+}
+
+
+void BigInt::AddAbs(const BigInt& other)
+{
+	size_t size1 = m_limbs.size();
+	size_t size2 = other.GetNumLimbs();
+	if (size1 <= BigIntLimbs::INLINE_LIMBS && size2 <= BigIntLimbs::INLINE_LIMBS)
+	{
+		// a fifth limb is needed only when the 128-bit sum overflows
+		Value128 a = Load128(m_limbs);
+		Value128 b = Load128(other.m_limbs);
+		dlimb_t carry = (a.low + b.low < a.low) ? 1 : 0;
+		Value128 sum = { a.low + b.low, a.high + b.high + carry };
+		Store128(m_limbs, sum);
+		if (sum.high < a.high || (carry != 0 && sum.high == a.high))
 		{
-			int d1 = str1[i] - '0';
-			int d2 = str2[i] - '0';
-			if (d1 == d2)
-				continue;
-			return ((d1 < d2) && (!sign1));
+			m_limbs.resize(BigIntLimbs::INLINE_LIMBS);
+			m_limbs.push_back(1);
 		}
-		// left and right are completely equal
-		return false;
+		return;
+	}
+	if (size1 < size2)
+	{
+		// |x| + |other| = |other| + |x|: copy the longer tail first, other != *this here
+		m_limbs.resize(size2);
+		std::copy(other.m_limbs.begin() + size1, other.m_limbs.end(), m_limbs.begin() + size1);
+		std::swap(size1, size2);
+	}
+	const limb_t* b = other.m_limbs.data();
+	limb_t carry = bigint_impl::AddN(m_limbs.data(), m_limbs.data(), b, size2);
+	// early stopping: carry dies out in the rest of the longer operand
+	carry = bigint_impl::Add1(m_limbs.data() + size2, m_limbs.data() + size2, size1 - size2, carry);
+	if (carry > 0)
+		m_limbs.push_back(carry);
+}
+
+
+void BigInt::SubAbs(const BigInt& other)
+{
+	assert(CompareAbs(*this, other) >= 0);
+	size_t size1 = m_limbs.size();
+	size_t size2 = other.GetNumLimbs();
+	if (size1 <= BigIntLimbs::INLINE_LIMBS)
+	{
+		Store128(m_limbs, Sub128(Load128(m_limbs), Load128(other.m_limbs)));
+		Normalize();
+		return;
+	}
+	bigint_impl::Sub(m_limbs.data(), m_limbs.data(), size1, other.m_limbs.data(), size2);
+	Normalize();
+}
+
+
+void BigInt::SubAbsFrom(const BigInt& other)
+{
+	assert(CompareAbs(*this, other) <= 0);
+	size_t size1 = m_limbs.size();
+	size_t size2 = other.GetNumLimbs();
+	if (size2 <= BigIntLimbs::INLINE_LIMBS)
+	{
+		Store128(m_limbs, Sub128(Load128(other.m_limbs), Load128(m_limbs)));
+		Normalize();
+		return;
 	}
+	m_limbs.resize(size2);
+	// low part: other - x limb by limb, high part: other's tail minus the borrow
+	const limb_t* b = other.m_limbs.data();
+	limb_t borrow = bigint_impl::SubN(m_limbs.data(), b, m_limbs.data(), size1);
+	bigint_impl::Sub1(m_limbs.data() + size1, b + size1, size2 - size1, borrow);
+	Normalize();
 }
 
 
-void BigInt::RemoveHeadingZeroes()
+void BigInt::MulAccumulate(const BigInt& a, const BigInt& b, bool negate)
 {
-	auto size = GetNumDigits();
-	if (size < 2)
+	if (a.IsZero() || b.IsZero())
 		return;
-	auto new_size = size;
-	for (int i = size - 1; i >= 1; --i)
+	bool product_sign = (a.GetSign() != b.GetSign()) != negate;
+	size_t size = a.GetNumLimbs() + b.GetNumLimbs();
+	if (IsZero())
 	{
-		if (m_str[i] != '0')
-			break;
-		--new_size;
+		// x is neither a nor b here: the product goes into its storage
+		m_limbs.resize(size);
+		bigint_impl::Mul(m_limbs.data(), a.m_limbs.data(), a.GetNumLimbs(), b.m_limbs.data(), b.GetNumLimbs());
+		m_sign = product_sign;
+		Normalize();
+		return;
 	}
-	if (new_size != size)
+
+	// a word factor: |x| += |long| * w in one pass, or |x| -= |long| * w when |x| is
+	// at least two limbs longer and so certainly larger
+	const BigInt& longer = (a.GetNumLimbs() >= b.GetNumLimbs()) ? a : b;
+	const BigInt& word = (&longer == &a) ? b : a;
+	size_t n = longer.GetNumLimbs();
+	if (word.GetNumLimbs() == 1 && &longer != this)
 	{
-		m_str.resize(new_size);
+		limb_t w = word.m_limbs[0];
+		if (product_sign == GetSign())
+		{
+			if (m_limbs.size() < n)
+				m_limbs.resize(n);
+			limb_t carry = bigint_impl::AddMul1(m_limbs.data(), longer.m_limbs.data(), n, w);
+			carry = bigint_impl::Add1(m_limbs.data() + n, m_limbs.data() + n, m_limbs.size() - n, carry);
+			if (carry > 0)
+				m_limbs.push_back(carry);
+			return;
+		}
+		if (m_limbs.size() > n + 1)
+		{
+			limb_t borrow = bigint_impl::SubMul1(m_limbs.data(), longer.m_limbs.data(), n, w);
+			bigint_impl::Sub1(m_limbs.data() + n, m_limbs.data() + n, m_limbs.size() - n, borrow);
+			Normalize();
+			return;
+		}
+	}
+
+	// the product into the thread's scratch buffer, then a signed addition of the span; the
+	// buffer comes from the global heap so that it may outlive any BigIntArena
+	thread_local std::vector<limb_t> scratch;
+	if (scratch.size() < size)
+		scratch.resize(size);
+	limb_t* p = scratch.data();
+	bigint_impl::Mul(p, a.m_limbs.data(), a.GetNumLimbs(), b.m_limbs.data(), b.GetNumLimbs());
+	size_t np = bigint_impl::Normalized(p, size);
+	size_t nx = m_limbs.size();
+	if (product_sign == GetSign())
+	{
+		if (nx < np)
+		{
+			m_limbs.resize(np);
+			nx = np;
+		}
+		limb_t carry = bigint_impl::Add(m_limbs.data(), m_limbs.data(), nx, p, np);
+		if (carry > 0)
+			m_limbs.push_back(carry);
+	}
+	else if (bigint_impl::Cmp(m_limbs.data(), nx, p, np) >= 0)
+	{
+		bigint_impl::Sub(m_limbs.data(), m_limbs.data(), nx, p, np);
+		Normalize();
+	}
+	else
+	{
+		// |x| = |product| - |x|, the sign of the product wins
+		m_limbs.resize(np);
+		bigint_impl::Sub(m_limbs.data(), p, np, m_limbs.data(), nx);
+		m_sign = product_sign;
+		Normalize();
+	}
+}
+
+
+void BigInt::DivMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder)
+{
+	BigInt q(a);
+	remainder = q.DivideBy(b);
+	quotient = std::move(q);
+}
+
+
+BigInt BigInt::Pow(const BigInt& base, size_t exp)
+{
+	// left-to-right binary powering: the squarings run on the growing result
+	BigInt result(1);
+	size_t bit = 1;
+	while (bit <= exp / 2)
+		bit <<= 1;
+	for (; bit > 0 && exp > 0; bit >>= 1)
+	{
+		result *= result;
+		if (exp & bit)
+			result *= base;
+	}
+	return result;
+}
+
+
+BigInt BigInt::FromLimbs(const limb_t* a, size_t n)
+{
+	BigInt x;
+	x.m_limbs.assign(a, a + n);
+	x.Normalize();
+	return x;
+}
+
+
+void BigInt::AssignWord(dlimb_t magnitude, bool negative)
+{
+	Store64(m_limbs, magnitude);
+	m_sign = negative && magnitude != 0;
+}
+
+
+void BigInt::AddWord(dlimb_t magnitude, bool negative)
+{
+	if (magnitude == 0)
+		return;
+	size_t size = m_limbs.size();
+	if (size <= DLIMB_LIMBS)
+	{
+		dlimb_t a = Load64(m_limbs);
+		if (IsZero() || m_sign == negative)
+		{
+			dlimb_t sum = a + magnitude;
+			Store64(m_limbs, sum);
+			if (sum < a)
+			{
+				m_limbs.resize(2);
+				m_limbs.push_back(1);
+			}
+			m_sign = negative;
+		}
+		else if (a >= magnitude)
+		{
+			Store64(m_limbs, a - magnitude);
+		}
+		else
+		{
+			Store64(m_limbs, magnitude - a);
+			m_sign = negative;
+		}
+		Normalize();
+		return;
+	}
+	// |x| > magnitude: the sign stays, a carry or borrow runs into the high limbs
+	limb_t w[2] = { static_cast<limb_t>(magnitude), static_cast<limb_t>(magnitude >> LIMB_BITS) };
+	size_t nw = (w[1] != 0) ? 2 : 1;
+	if (m_sign == negative)
+	{
+		limb_t carry = bigint_impl::Add(m_limbs.data(), m_limbs.data(), size, w, nw);
+		if (carry > 0)
+			m_limbs.push_back(carry);
+	}
+	else
+	{
+		bigint_impl::Sub(m_limbs.data(), m_limbs.data(), size, w, nw);
+		Normalize();
 	}
 }
 
 
-BigInt& BigInt::MulByOneDigitNumber(int num)
+void BigInt::MulWord(dlimb_t magnitude, bool negative)
 {
-	assert(num >= 0 && num <= 9);
-	if (num == 0)
+	if (IsZero() || magnitude == 0)
 	{
-		m_str = "0";
+		m_limbs.clear();
 		m_sign = false;
-		return *this;
+		return;
 	}
-	if (num == 1)
+	bool sign = (m_sign != negative);
+	if (magnitude >> LIMB_BITS == 0)
 	{
-		return *this;
+		limb_t high = bigint_impl::Mul1(m_limbs.data(), m_limbs.data(), m_limbs.size(), static_cast<limb_t>(magnitude));
+		if (high > 0)
+			m_limbs.push_back(high);
 	}
-	int carry = 0;
-	auto size = GetNumDigits();
-	for (int i = 0; i < size; ++i)
+	else
 	{
-		int d1 = m_str[i] - '0';
-		int result = d1 * num + carry;
-		int digit = result % 10;
-		carry = result / 10;
-		char c = '0' + digit;
-		m_str[i] = c;
+		limb_t w[2] = { static_cast<limb_t>(magnitude), static_cast<limb_t>(magnitude >> LIMB_BITS) };
+		size_t size = m_limbs.size() + 2;
+		BigIntLimbs result;
+		result.resize(size);
+		bigint_impl::MulBasecase(result.data(), m_limbs.data(), m_limbs.size(), w, 2);
+		result.resize(bigint_impl::Normalized(result.data(), size));
+		m_limbs.swap(result);
 	}
-	if (carry > 0)
-		m_str.push_back('0' + carry);
-	
-	return *this;
+	m_sign = sign;
 }
 
 
-BigInt& BigInt::MulByTen(size_t k)
+void BigInt::DivWord(dlimb_t magnitude, bool negative)
 {
-	if (k == 0)
-		return *this;
-	std::string zeroes(k, '0');
-	zeroes.append(m_str);
-	m_str = zeroes;
-	return *this;
+	if (magnitude == 0)
+		throw std::domain_error("BigInt division by zero");
+	bool sign = (m_sign != negative);
+	size_t size = m_limbs.size();
+	if (size <= DLIMB_LIMBS)
+	{
+		Store64(m_limbs, Load64(m_limbs) / magnitude);
+	}
+	else if (magnitude >> LIMB_BITS == 0)
+	{
+		bigint_impl::DivRem1(m_limbs.data(), m_limbs.data(), size, static_cast<limb_t>(magnitude));
+	}
+	else
+	{
+		limb_t w[2] = { static_cast<limb_t>(magnitude), static_cast<limb_t>(magnitude >> LIMB_BITS) };
+		limb_t r[2];
+		BigIntLimbs quotient;
+		quotient.resize(size - 1);
+		bigint_impl::DivRem(quotient.data(), r, m_limbs.data(), size, w, 2);
+		m_limbs.swap(quotient);
+	}
+	m_sign = sign;
+	Normalize();
 }
 
 
-BigInt BigInt::DivideBy(const BigInt& other)
+void BigInt::ModWord(dlimb_t magnitude)
 {
-	auto size1 = GetNumDigits();
-	auto size2 = other.GetNumDigits();
-	auto max_size = std::max(size1, size2);
-	const std::string& str2 = other.GetStr();
+	if (magnitude == 0)
+		throw std::domain_error("BigInt division by zero");
+	size_t size = m_limbs.size();
+	if (size <= DLIMB_LIMBS)
+	{
+		Store64(m_limbs, Load64(m_limbs) % magnitude);
+	}
+	else if (magnitude >> LIMB_BITS == 0)
+	{
+		Store64(m_limbs, bigint_impl::Mod1(m_limbs.data(), size, static_cast<limb_t>(magnitude)));
+	}
+	else
+	{
+		limb_t w[2] = { static_cast<limb_t>(magnitude), static_cast<limb_t>(magnitude >> LIMB_BITS) };
+		limb_t r[2];
+		BigIntLimbs quotient;
+		quotient.resize(size - 1);
+		bigint_impl::DivRem(quotient.data(), r, m_limbs.data(), size, w, 2);
+		m_limbs.assign(r, r + 2);
+	}
+	Normalize();  // the sign stays that of x unless the remainder is zero
+}
+
 
+int BigInt::CompareWord(dlimb_t magnitude, bool negative) const
+{
+	negative = negative && magnitude != 0;
+	if (m_sign != negative)
+		return m_sign ? -1 : 1;
+	int cmp = 1;
+	if (m_limbs.size() <= DLIMB_LIMBS)
+	{
+		dlimb_t a = Load64(m_limbs);
+		cmp = (a == magnitude) ? 0 : ((a < magnitude) ? -1 : 1);
+	}
+	return m_sign ? -cmp : cmp;
+}
+
+
+BigInt BigInt::DivideBy(const BigInt& other)
+{
 	bool sign1 = GetSign();
 	bool sign2 = other.GetSign();
 
-	BigInt b = other.Abs();
-
-	 /*TODO:
-	 beware of signs to get correct remainder!!!
-	 Python: 
-	 23 // 100 = 0
-	 23 // -100 = -1
-	 -23 // 100 = -1
-	 -23 // -100 = 0
-	 23 % 100 = 23
-	 -23 % 100 = 77
-	 23 % -100 = -77
-	 -23 % -100 = -23
-	 
-	 C++:
-	 23 / 100 = 0
-	 23 / -100 = 0
-	 -23 / 100 = 0
-	 -23 / -100 = 0
-	 23 % 100 = 23
-	 -23 % 100 = -23
-	 23 % -100 = 23
-	 -23 % -100 = -23
-	 */
-
-	if (Abs() < b)
-	{
-		BigInt tmp(*this);
-		m_str = "0";
-		m_sign = false;
-		return tmp;  // remainder
+	if (other.IsZero())
+		throw std::domain_error("BigInt division by zero");
+
+	// the quotient truncates toward zero and the remainder takes the sign of the dividend, as in C++
+	int cmp = CompareAbs(*this, other);
+	if (cmp < 0)
+	{
+		return BigInt(std::move(*this));  // remainder; leaves zero quotient behind
 	}
-	if (Abs() == b)
+	if (cmp == 0)
 	{
-		m_str = "1";
+		m_limbs.assign(1, 1);
 		m_sign = (sign1 != sign2);
-		return BigInt(0);  // remainder
+		return BigInt();  // remainder
 	}
-	std::string divisor;
-	int j = size1 - size2;
-	j = (j < 0) ? 0 : j;
-	BigInt r(ReverseStr(m_str.substr(j, size2)));
-	while (j >= 0)
+
+	BigInt r;
+	if (m_limbs.size() <= DLIMB_LIMBS)
 	{
-		if (r < b)
-		{
-			j--;
-			if (j < 0)
-				break;
-			r = r * 10 + BigInt(m_str[j] - '0');
-		}
-		int d = 0;
-		while (r >= b)
-		{
-			r -= b;
-			d++;
-		}
-		divisor.push_back(d + '0');
+		// both fit in 64 bits: native division
+		dlimb_t a = Load64(m_limbs);
+		dlimb_t d = Load64(other.m_limbs);
+		Store64(m_limbs, a / d);
+		Store64(r.m_limbs, a % d);
+		m_sign = (sign1 != sign2);
+		Normalize();
+		if (sign1)
+			r.Negate();
+		return r;
 	}
-	m_str = ReverseStr(divisor);
+
+	// quotient and remainder in one pass: single-limb divisor fast path or Knuth's Algorithm D
+	const BigIntLimbs& b = other.GetLimbs();
+	BigIntLimbs quotient;
+	quotient.resize(m_limbs.size() - b.size() + 1);
+	if (b.size() == 1)
+	{
+		limb_t rem = bigint_impl::DivRem1(quotient.data(), m_limbs.data(), m_limbs.size(), b[0]);
+		if (rem != 0)
+			r.m_limbs.push_back(rem);
+	}
+	else
+	{
+		r.m_limbs.resize(b.size());
+		bigint_impl::DivRem(quotient.data(), r.m_limbs.data(), m_limbs.data(), m_limbs.size(), b.data(), b.size());
+		r.Normalize();
+	}
+	m_limbs.swap(quotient);
 	m_sign = (sign1 != sign2);
+	Normalize();
 	if (sign1)
 		r.Negate();  // in C++, sign(remainder) == sign(*this)
 	return r;
@@ -483,28 +1121,28 @@ BigInt BigInt::DivideBy(const BigInt& other)
 
 bool operator>(const BigInt& left, const BigInt& right)
 {
-	return right < left;
+	return BigInt::Compare(left, right) > 0;
 }
 
 
 bool operator==(const BigInt& left, const BigInt& right)
 {
-	// patch for (-0) == (0)
-	if (left.GetNumDigits() == 1 && right.GetNumDigits() == 1 && left.GetStr()[0] == '0' && right.GetStr()[0] == '0')
-		return true;
-	return !((left > right) || (left < right));
+	// no order is needed: values of different lengths differ, equal ones match limb for limb
+	const BigIntLimbs& a = left.GetLimbs();
+	const BigIntLimbs& b = right.GetLimbs();
+	return left.GetSign() == right.GetSign() && a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
 }
 
 
 bool operator<=(const BigInt& left, const BigInt& right)
 {
-	return !(left > right);
+	return BigInt::Compare(left, right) <= 0;
 }
 
 
 bool operator>=(const BigInt& left, const BigInt& right)
 {
-	return !(left < right);
+	return BigInt::Compare(left, right) >= 0;
 }
 
 
@@ -514,7 +1152,15 @@ bool operator!=(const BigInt& left, const BigInt& right)
 }
 
 
-const BigInt operator+(const BigInt& left, const BigInt& right)
+#ifdef BIGINT_THREE_WAY_COMPARISON
+std::strong_ordering operator<=>(const BigInt& left, const BigInt& right)
+{
+	return BigInt::Compare(left, right) <=> 0;
+}
+#endif
+
+
+BigInt operator+(const BigInt& left, const BigInt& right)
 {
 	BigInt tmp = left;
 	tmp += right;
@@ -522,7 +1168,28 @@ const BigInt operator+(const BigInt& left, const BigInt& right)
 }
 
 
-const BigInt operator-(const BigInt& left, const BigInt& right)
+BigInt operator+(BigInt&& left, const BigInt& right)
+{
+	left += right;
+	return std::move(left);
+}
+
+
+BigInt operator+(const BigInt& left, BigInt&& right)
+{
+	right += left;
+	return std::move(right);
+}
+
+
+BigInt operator+(BigInt&& left, BigInt&& right)
+{
+	left += right;
+	return std::move(left);
+}
+
+
+BigInt operator-(const BigInt& left, const BigInt& right)
 {
 	BigInt tmp = left;
 	tmp -= right;
@@ -530,7 +1197,30 @@ const BigInt operator-(const BigInt& left, const BigInt& right)
 }
 
 
-const BigInt operator*(const BigInt& left, const BigInt& right)
+BigInt operator-(BigInt&& left, const BigInt& right)
+{
+	left -= right;
+	return std::move(left);
+}
+
+
+BigInt operator-(const BigInt& left, BigInt&& right)
+{
+	// left - right = -(right - left)
+	right -= left;
+	right.Negate();
+	return std::move(right);
+}
+
+
+BigInt operator-(BigInt&& left, BigInt&& right)
+{
+	left -= right;
+	return std::move(left);
+}
+
+
+BigInt operator*(const BigInt& left, const BigInt& right)
 {
 	BigInt tmp = left;
 	tmp *= right;
@@ -538,7 +1228,28 @@ const BigInt operator*(const BigInt& left, const BigInt& right)
 }
 
 
-const BigInt operator/(const BigInt& left, const BigInt& right)
+BigInt operator*(BigInt&& left, const BigInt& right)
+{
+	left *= right;
+	return std::move(left);
+}
+
+
+BigInt operator*(const BigInt& left, BigInt&& right)
+{
+	right *= left;
+	return std::move(right);
+}
+
+
+BigInt operator*(BigInt&& left, BigInt&& right)
+{
+	left *= right;
+	return std::move(left);
+}
+
+
+BigInt operator/(const BigInt& left, const BigInt& right)
 {
 	BigInt tmp = left;
 	tmp /= right;
@@ -546,9 +1257,77 @@ const BigInt operator/(const BigInt& left, const BigInt& right)
 }
 
 
-const BigInt operator%(const BigInt& left, const BigInt& right)
+BigInt operator/(BigInt&& left, const BigInt& right)
+{
+	left /= right;
+	return std::move(left);
+}
+
+
+BigInt operator%(const BigInt& left, const BigInt& right)
 {
 	BigInt tmp = left;
 	tmp %= right;
 	return tmp;
 }
+
+
+BigInt operator%(BigInt&& left, const BigInt& right)
+{
+	left %= right;
+	return std::move(left);
+}
+
+
+BigInt operator&(const BigInt& left, const BigInt& right)
+{
+	BigInt tmp = left;
+	tmp &= right;
+	return tmp;
+}
+
+
+BigInt operator|(const BigInt& left, const BigInt& right)
+{
+	BigInt tmp = left;
+	tmp |= right;
+	return tmp;
+}
+
+
+BigInt operator^(const BigInt& left, const BigInt& right)
+{
+	BigInt tmp = left;
+	tmp ^= right;
+	return tmp;
+}
+
+
+BigInt operator<<(const BigInt& x, size_t bits)
+{
+	BigInt tmp = x;
+	tmp <<= bits;
+	return tmp;
+}
+
+
+BigInt operator<<(BigInt&& x, size_t bits)
+{
+	x <<= bits;
+	return std::move(x);
+}
+
+
+BigInt operator>>(const BigInt& x, size_t bits)
+{
+	BigInt tmp = x;
+	tmp >>= bits;
+	return tmp;
+}
+
+
+BigInt operator>>(BigInt&& x, size_t bits)
+{
+	x >>= bits;
+	return std::move(x);
+}
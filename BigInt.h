@@ -1,21 +1,74 @@
 #pragma once
 
+#include "BigIntArena.h"
+#include "BigIntLimbs.h"
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <string>
+#include <type_traits>
+#include <vector>
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#include <compare>
+#define BIGINT_THREE_WAY_COMPARISON 1
+#endif
+
+// crossover sizes of the arithmetic algorithms, in limbs of the smaller operand;
+// the defaults are reasonable for x86-64, retune them with the benchmark for other targets
+struct BigIntThresholds
+{
+	size_t mul_karatsuba = 32;  // schoolbook multiplication below
+	size_t mul_toom3 = 128;  // Karatsuba multiplication below
+	size_t mul_ntt = 5000;  // Toom-3 multiplication below, NTT above
+	size_t div_bz = 60;  // Algorithm D below, Burnikel-Ziegler recursive division above
+	size_t conv_dc = 30;  // quadratic decimal conversion below, divide and conquer above
+	size_t gcd_hgcd = 100;  // Lehmer's GCD below, recursive half-GCD above
+	size_t mul_parallel = 20000;  // single-threaded multiplication below, split over SetNumThreads() threads above
+};
+
+
+// built-in integers of up to 64 bits are operands on their own: arithmetic and comparison
+// with them take single-word paths and never build a temporary BigInt
+template<typename T, typename R>
+using BigIntIfWord = typename std::enable_if<std::is_integral<T>::value && sizeof(T) <= sizeof(uint64_t), R>::type;
+
+// node of a lazy arithmetic expression, see BigIntExpr.h
+template<typename E> class BigIntExpr;
+
 
 class BigInt
 {
 public:
+	typedef uint32_t limb_t;   // one binary digit of base 2^32
+	typedef uint64_t dlimb_t;  // holds a full limb-by-limb product
+	static const int LIMB_BITS = 32;
+
 	BigInt();
-	explicit BigInt(const std::string& view_str);
+	explicit BigInt(const std::string& view_str);  // throws std::invalid_argument unless [+-]digits
+	BigInt(const char* text, size_t size);  // the same over a range, e.g. a memory-mapped file, without a copy
 	BigInt(const int& i);
+	template<typename T, typename = BigIntIfWord<T, void>>
+	BigInt(T i) { AssignWord(WordMagnitude(i), WordIsNegative(i)); }
 	BigInt(const BigInt& other);
+	BigInt(BigInt&& other) noexcept;  // other is left zero
 
 	BigInt& operator=(const BigInt& other);
+	BigInt& operator=(BigInt&& other) noexcept;
+	template<typename T> BigIntIfWord<T, BigInt&> operator=(T i) { AssignWord(WordMagnitude(i), WordIsNegative(i)); return *this; }  // keeps the storage
+	// expressions of BigIntExpr.h are evaluated into the storage of this value
+	template<typename E> BigInt(const BigIntExpr<E>& e);
+	template<typename E> BigInt& operator=(const BigIntExpr<E>& e);
+	template<typename E> BigInt& operator+=(const BigIntExpr<E>& e);
+	template<typename E> BigInt& operator-=(const BigIntExpr<E>& e);
 
 	// getters
-	const std::string& GetStr() const { return m_str; }
+	const BigIntLimbs& GetLimbs() const { return m_limbs; }
+	static BigInt FromLimbs(const limb_t* a, size_t n);  // non-negative value of n limbs as in GetLimbs(), heading zeroes allowed
 	bool GetSign() const { return m_sign; }
-	size_t GetNumDigits() const { return m_str.size(); }
+	size_t GetNumLimbs() const { return m_limbs.size(); }
+	size_t GetNumDigits() const;  // decimal digits of abs value, needs a full radix conversion
+	bool IsZero() const { return m_limbs.empty(); }
 
 	// OPERATORS
 	// compound arithmetic
@@ -24,8 +77,22 @@ public:
 	BigInt& operator*=(const BigInt& other);
 	BigInt& operator/=(const BigInt& other);
 	BigInt& operator%=(const BigInt& other);
+	template<typename T> BigIntIfWord<T, BigInt&> operator+=(T other) { AddWord(WordMagnitude(other), WordIsNegative(other)); return *this; }
+	template<typename T> BigIntIfWord<T, BigInt&> operator-=(T other) { AddWord(WordMagnitude(other), !WordIsNegative(other)); return *this; }
+	template<typename T> BigIntIfWord<T, BigInt&> operator*=(T other) { MulWord(WordMagnitude(other), WordIsNegative(other)); return *this; }
+	template<typename T> BigIntIfWord<T, BigInt&> operator/=(T other) { DivWord(WordMagnitude(other), WordIsNegative(other)); return *this; }
+	template<typename T> BigIntIfWord<T, BigInt&> operator%=(T other) { ModWord(WordMagnitude(other)); return *this; }
+	// compound bitwise: x behaves as its infinite two's complement, so -1 has all bits set;
+	// shifts move whole limbs and then bits, >> rounds toward minus infinity as for built-in ints
+	BigInt& operator&=(const BigInt& other);
+	BigInt& operator|=(const BigInt& other);
+	BigInt& operator^=(const BigInt& other);
+	BigInt& operator<<=(size_t bits);
+	BigInt& operator>>=(size_t bits);
 	// unary arithmetic
-	const BigInt operator-() const;
+	BigInt operator-() const &;
+	BigInt operator-() &&;  // reuses the storage of a temporary
+	BigInt operator~() const;  // -x - 1
 	// increments/decrements
 	BigInt& operator++();  // prefix
 	BigInt& operator--();
@@ -34,37 +101,175 @@ public:
 
 	// methods
 	void Negate();  // change sign in-place
-	const BigInt Abs() const;  // get copy of absolute value
+	// x += a * b and x -= a * b without a temporary: the product goes straight into x when x is
+	// zero, a single-limb factor is fused into one pass over x, other products take a scratch
+	// buffer kept by the thread; a and b may be x itself
+	void AddMul(const BigInt& a, const BigInt& b);
+	void SubMul(const BigInt& a, const BigInt& b);
+	BigInt Abs() const &;  // get copy of absolute value
+	BigInt Abs() &&;
+	// bits
+	size_t BitLength() const;  // bits of |x|, 0 for zero
+	bool TestBit(size_t i) const;  // bit i of the two's complement of x
+	size_t PopCount() const;  // set bits of |x|
+	size_t TrailingZeros() const;  // zero bits below the lowest set one, the same for x and -x; 0 for zero
+	static int CompareAbs(const BigInt& a, const BigInt& b);  // sign of |a| - |b|: -1, 0 or 1
+	static int Compare(const BigInt& a, const BigInt& b);  // sign of a - b: -1, 0 or 1, in one pass over the limbs
+	template<typename T>
+	static BigIntIfWord<T, int> Compare(const BigInt& a, T b) { return a.CompareWord(WordMagnitude(b), WordIsNegative(b)); }
+	// quotient truncated toward zero and remainder with the sign of a, as for built-in ints
+	static void DivMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder);
+	static BigInt Pow(const BigInt& base, size_t exp);  // base^exp, 0^0 == 1
+	// base^exp mod |mod| in [0, |mod|); throws std::domain_error if mod == 0 or exp < 0.
+	// Reduces by Montgomery multiplication for odd moduli and by Barrett reduction otherwise,
+	// see MontgomeryContext for many operations with one modulus
+	static BigInt PowMod(const BigInt& base, const BigInt& exp, const BigInt& mod);
+	static BigInt Gcd(const BigInt& a, const BigInt& b);  // non-negative, Gcd(0, 0) == 0
+	// returns Gcd(a, b) and sets Bezout coefficients with a * x + b * y == Gcd(a, b)
+	static BigInt ExtendedGcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y);
+	// x in [0, |mod|) with a * x == 1 mod |mod|; throws std::domain_error if mod == 0 or Gcd(a, mod) != 1
+	static BigInt ModInverse(const BigInt& a, const BigInt& mod);
+	// roots truncated toward zero; even roots of negative values throw std::domain_error,
+	// k == 0 throws std::invalid_argument
+	static BigInt ISqrt(const BigInt& x);
+	static BigInt IRoot(const BigInt& x, unsigned k);
+	static bool IsPerfectSquare(const BigInt& x);
+	static bool IsPerfectPower(const BigInt& x);  // x == y^k for some integers y and k >= 2, so 0, 1 and -1 are perfect powers
+	static BigInt Factorial(unsigned n);
+	static BigInt Binomial(unsigned n, unsigned k);  // 0 for k > n
+	static BigInt Primorial(unsigned n);  // product of the primes up to n
+	static BigIntThresholds& Thresholds();  // process-wide, not synchronized: tune before computing
+	// threads of the work-stealing pool shared by large multiplications, 1 (the default) keeps
+	// all work on the calling thread and 0 means one per hardware thread; not synchronized either
+	static void SetNumThreads(size_t n);
+	static size_t GetNumThreads();
 
 	// viewing
 	std::string GetViewStr() const;
+	// [-]digits in base 2..36 (lower-case letters) into [first, last) like std::to_chars: returns
+	// {end, errc()} or {last, errc::value_too_large}, allocating nothing for values of up to
+	// 16 limbs and for power-of-two bases; other bases throw std::invalid_argument
+	std::to_chars_result ToChars(char* first, char* last, int base = 10) const;
+	// [-]digits of the base, letters in either case, like std::from_chars: value is set from the
+	// longest prefix of digits; without digits returns {first, errc::invalid_argument} and
+	// leaves value unchanged
+	static std::from_chars_result FromChars(const char* first, const char* last, BigInt& value, int base = 10);
+	size_t DigitCountUpperBound(int base = 10) const;  // a buffer this long always fits ToChars, sign included
+	// [-]digits handed to sink piece by piece, most significant first: the whole text is never
+	// held, so huge values go to a file or socket with memory proportional to their binary size
+	void WriteDecimal(const std::function<void(const char*, size_t)>& sink) const;
+	// "(value)", written as WriteDecimal produces it; stream << BigIntNoParens drops the parentheses
 	friend std::ostream& operator<<(std::ostream& stream, const BigInt& x);
+	// [+-]digits after whitespace, parsed by blocks without keeping the text; without digits
+	// sets failbit and leaves x unchanged
+	friend std::istream& operator>>(std::istream& stream, BigInt& x);
+
+	// binary form: a LEB128 varint of 2 * limbs + sign, then the limbs least significant first,
+	// 4 little-endian bytes each; BigIntView reads it in place
+	size_t GetSerializedSize() const;
+	size_t Serialize(uint8_t* out) const;  // writes GetSerializedSize() bytes, returns their count
+	std::vector<uint8_t> Serialize() const;
+	// throws std::invalid_argument on truncated or non-canonical input; *used gets the bytes read
+	static BigInt Deserialize(const uint8_t* data, size_t size, size_t* used = nullptr);
 
 private:
-	std::string ReverseStr(const std::string& s) const;
-	void RemoveHeadingZeroes(); // in-place
+	void Normalize(); // in-place: drop heading zero limbs, zero is always non-negative
+	void AddSigned(const BigInt& other, bool negate_other);  // x += other or x -= other, in place
+	void AddAbs(const BigInt& other);  // |x| += |other|
+	void SubAbs(const BigInt& other);  // |x| -= |other|, requires |x| >= |other|
+	void SubAbsFrom(const BigInt& other);  // |x| = |other| - |x|, requires |x| <= |other|
+	void MulAccumulate(const BigInt& a, const BigInt& b, bool negate);  // x += a * b or x -= a * b
 	BigInt DivideBy(const BigInt& b);
-	BigInt& MulByOneDigitNumber(int num);  // num is [0; 9]
-	BigInt& MulByTen(size_t k); // x *= (10 ** k)
+	// single-word operands as magnitude and sign, the magnitude of INT64_MIN included
+	template<typename T> static bool WordIsNegative(T i) { return std::is_signed<T>::value && static_cast<int64_t>(i) < 0; }
+	template<typename T> static dlimb_t WordMagnitude(T i) { return WordIsNegative(i) ? 0 - static_cast<dlimb_t>(i) : static_cast<dlimb_t>(i); }
+	void AssignWord(dlimb_t magnitude, bool negative);
+	void AddWord(dlimb_t magnitude, bool negative);  // x += +-magnitude
+	void MulWord(dlimb_t magnitude, bool negative);
+	void DivWord(dlimb_t magnitude, bool negative);  // quotient truncated toward zero
+	void ModWord(dlimb_t magnitude);  // remainder with the sign of x
+	int CompareWord(dlimb_t magnitude, bool negative) const;
 
 private:
-	std::string m_str;  // contains digits in reverse order
+	BigIntLimbs m_limbs;  // abs value in base 2^32, least significant limb first, no heading zero limbs
 	bool m_sign = false;  // false means non-negative, true means negative
 };
 
 
+// manipulators of operator<<: machine output without parentheses, and back to the default
+std::ostream& BigIntNoParens(std::ostream& stream);
+std::ostream& BigIntParens(std::ostream& stream);
+
+
 // OPERATORS
-// binary arithmetic
-const BigInt operator+(const BigInt& left, const BigInt& right);
-const BigInt operator-(const BigInt& left, const BigInt& right);
-const BigInt operator*(const BigInt& left, const BigInt& right);
-const BigInt operator/(const BigInt& left, const BigInt& right);
-const BigInt operator%(const BigInt& left, const BigInt& right);
-
-// comparison
+// binary arithmetic; overloads taking a temporary compute the result in its storage
+BigInt operator+(const BigInt& left, const BigInt& right);
+BigInt operator+(BigInt&& left, const BigInt& right);
+BigInt operator+(const BigInt& left, BigInt&& right);
+BigInt operator+(BigInt&& left, BigInt&& right);
+BigInt operator-(const BigInt& left, const BigInt& right);
+BigInt operator-(BigInt&& left, const BigInt& right);
+BigInt operator-(const BigInt& left, BigInt&& right);
+BigInt operator-(BigInt&& left, BigInt&& right);
+BigInt operator*(const BigInt& left, const BigInt& right);
+BigInt operator*(BigInt&& left, const BigInt& right);
+BigInt operator*(const BigInt& left, BigInt&& right);
+BigInt operator*(BigInt&& left, BigInt&& right);
+BigInt operator/(const BigInt& left, const BigInt& right);
+BigInt operator/(BigInt&& left, const BigInt& right);
+BigInt operator%(const BigInt& left, const BigInt& right);
+BigInt operator%(BigInt&& left, const BigInt& right);
+BigInt operator&(const BigInt& left, const BigInt& right);
+BigInt operator|(const BigInt& left, const BigInt& right);
+BigInt operator^(const BigInt& left, const BigInt& right);
+BigInt operator<<(const BigInt& x, size_t bits);
+BigInt operator<<(BigInt&& x, size_t bits);
+BigInt operator>>(const BigInt& x, size_t bits);
+BigInt operator>>(BigInt&& x, size_t bits);
+
+// comparison; == only checks the sign and the length before it compares limbs,
+// the others go through a single Compare()
 bool operator<(const BigInt& left, const BigInt& right);
 bool operator>(const BigInt& left, const BigInt& right);
 bool operator<=(const BigInt& left, const BigInt& right);
 bool operator>=(const BigInt& left, const BigInt& right);
 bool operator==(const BigInt& left, const BigInt& right);
-bool operator!=(const BigInt& left, const BigInt& right);
\ No newline at end of file
+bool operator!=(const BigInt& left, const BigInt& right);
+#ifdef BIGINT_THREE_WAY_COMPARISON
+std::strong_ordering operator<=>(const BigInt& left, const BigInt& right);
+#endif
+
+
+// single-word operands; the word may come first where the operation commutes
+template<typename T> BigIntIfWord<T, BigInt> operator+(const BigInt& left, T right) { BigInt tmp = left; tmp += right; return tmp; }
+template<typename T> BigIntIfWord<T, BigInt> operator+(BigInt&& left, T right) { left += right; return std::move(left); }
+template<typename T> BigIntIfWord<T, BigInt> operator+(T left, const BigInt& right) { return right + left; }
+template<typename T> BigIntIfWord<T, BigInt> operator+(T left, BigInt&& right) { return std::move(right) + left; }
+template<typename T> BigIntIfWord<T, BigInt> operator-(const BigInt& left, T right) { BigInt tmp = left; tmp -= right; return tmp; }
+template<typename T> BigIntIfWord<T, BigInt> operator-(BigInt&& left, T right) { left -= right; return std::move(left); }
+template<typename T> BigIntIfWord<T, BigInt> operator-(T left, const BigInt& right) { return -(right - left); }
+template<typename T> BigIntIfWord<T, BigInt> operator-(T left, BigInt&& right) { return -(std::move(right) - left); }
+template<typename T> BigIntIfWord<T, BigInt> operator*(const BigInt& left, T right) { BigInt tmp = left; tmp *= right; return tmp; }
+template<typename T> BigIntIfWord<T, BigInt> operator*(BigInt&& left, T right) { left *= right; return std::move(left); }
+template<typename T> BigIntIfWord<T, BigInt> operator*(T left, const BigInt& right) { return right * left; }
+template<typename T> BigIntIfWord<T, BigInt> operator*(T left, BigInt&& right) { return std::move(right) * left; }
+template<typename T> BigIntIfWord<T, BigInt> operator/(const BigInt& left, T right) { BigInt tmp = left; tmp /= right; return tmp; }
+template<typename T> BigIntIfWord<T, BigInt> operator/(BigInt&& left, T right) { left /= right; return std::move(left); }
+template<typename T> BigIntIfWord<T, BigInt> operator%(const BigInt& left, T right) { BigInt tmp = left; tmp %= right; return tmp; }
+template<typename T> BigIntIfWord<T, BigInt> operator%(BigInt&& left, T right) { left %= right; return std::move(left); }
+
+template<typename T> BigIntIfWord<T, bool> operator<(const BigInt& left, T right) { return BigInt::Compare(left, right) < 0; }
+template<typename T> BigIntIfWord<T, bool> operator>(const BigInt& left, T right) { return BigInt::Compare(left, right) > 0; }
+template<typename T> BigIntIfWord<T, bool> operator<=(const BigInt& left, T right) { return BigInt::Compare(left, right) <= 0; }
+template<typename T> BigIntIfWord<T, bool> operator>=(const BigInt& left, T right) { return BigInt::Compare(left, right) >= 0; }
+template<typename T> BigIntIfWord<T, bool> operator==(const BigInt& left, T right) { return BigInt::Compare(left, right) == 0; }
+template<typename T> BigIntIfWord<T, bool> operator!=(const BigInt& left, T right) { return BigInt::Compare(left, right) != 0; }
+template<typename T> BigIntIfWord<T, bool> operator<(T left, const BigInt& right) { return BigInt::Compare(right, left) > 0; }
+template<typename T> BigIntIfWord<T, bool> operator>(T left, const BigInt& right) { return BigInt::Compare(right, left) < 0; }
+template<typename T> BigIntIfWord<T, bool> operator<=(T left, const BigInt& right) { return BigInt::Compare(right, left) >= 0; }
+template<typename T> BigIntIfWord<T, bool> operator>=(T left, const BigInt& right) { return BigInt::Compare(right, left) <= 0; }
+template<typename T> BigIntIfWord<T, bool> operator==(T left, const BigInt& right) { return BigInt::Compare(right, left) == 0; }
+template<typename T> BigIntIfWord<T, bool> operator!=(T left, const BigInt& right) { return BigInt::Compare(right, left) != 0; }
+#ifdef BIGINT_THREE_WAY_COMPARISON
+template<typename T> BigIntIfWord<T, std::strong_ordering> operator<=>(const BigInt& left, T right) { return BigInt::Compare(left, right) <=> 0; }
+#endif
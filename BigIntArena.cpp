@@ -0,0 +1,123 @@
+#include "BigIntArena.h"
+#include "BigIntLimbs.h"
+#include <algorithm>
+#include <new>
+
+
+namespace
+{
+	thread_local BigIntArena* current_arena = nullptr;
+
+	// arena blocks are aligned for the block header pointer, which covers the limbs too
+	const size_t ALIGNMENT = sizeof(void*);
+
+
+	size_t RoundUp(size_t bytes)
+	{
+		return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	}
+
+
+	// every heap block of limbs starts with the arena it came from, nullptr for the global heap,
+	// so a value is freed correctly whichever scope is active when it dies
+	struct BlockHeader
+	{
+		BigIntArena* arena;
+	};
+	const size_t HEADER_BYTES = RoundUp(sizeof(BlockHeader));
+}
+
+
+BigIntArena::BigIntArena(size_t chunk_bytes) :
+	m_chunk_bytes(std::max<size_t>(chunk_bytes, 1024))
+{}
+
+
+void* BigIntArena::Allocate(size_t bytes)
+{
+	bytes = RoundUp(bytes);
+	if (m_chunks.empty() || m_used + bytes > m_chunks.back().size)
+		AddChunk(bytes);
+	void* p = m_chunks.back().data.get() + m_used;
+	m_used += bytes;
+	++m_stats.allocations;
+	m_stats.bytes += bytes;
+	return p;
+}
+
+
+void BigIntArena::Deallocate(void* p, size_t bytes)
+{
+	++m_stats.deallocations;
+	// short-lived temporaries are often freed in reverse order: give the top block back
+	bytes = RoundUp(bytes);
+	if (!m_chunks.empty() && bytes <= m_used && static_cast<char*>(p) == m_chunks.back().data.get() + m_used - bytes)
+		m_used -= bytes;
+}
+
+
+void BigIntArena::Reset()
+{
+	if (m_chunks.size() > 1)
+	{
+		size_t total = m_stats.reserved;
+		m_chunks.clear();
+		m_stats.reserved = 0;
+		AddChunk(total);
+	}
+	m_used = 0;
+}
+
+
+void BigIntArena::AddChunk(size_t min_bytes)
+{
+	// the unused tail of the previous chunk is abandoned until Reset()
+	size_t size = std::max(m_chunk_bytes, min_bytes);
+	Chunk chunk;
+	chunk.data.reset(new char[size]);
+	chunk.size = size;
+	m_chunks.push_back(std::move(chunk));
+	m_used = 0;
+	m_stats.reserved += size;
+	m_chunk_bytes = 2 * size;
+}
+
+
+BigIntArena* BigIntArena::Current()
+{
+	return current_arena;
+}
+
+
+BigIntArenaScope::BigIntArenaScope(BigIntArena& arena) :
+	m_previous(current_arena)
+{
+	current_arena = &arena;
+}
+
+
+BigIntArenaScope::~BigIntArenaScope()
+{
+	current_arena = m_previous;
+}
+
+
+BigIntLimbs::limb_t* BigIntLimbs::Allocate(size_t n)
+{
+	size_t bytes = HEADER_BYTES + n * sizeof(limb_t);
+	BigIntArena* arena = current_arena;
+	void* block = arena ? arena->Allocate(bytes) : ::operator new(bytes);
+	static_cast<BlockHeader*>(block)->arena = arena;
+	return reinterpret_cast<limb_t*>(static_cast<char*>(block) + HEADER_BYTES);
+}
+
+
+void BigIntLimbs::Deallocate(limb_t* p, size_t n)
+{
+	void* block = reinterpret_cast<char*>(p) - HEADER_BYTES;
+	BigIntArena* arena = static_cast<BlockHeader*>(block)->arena;
+	if (arena)
+		arena->Deallocate(block, HEADER_BYTES + n * sizeof(limb_t));
+	else
+		::operator delete(block);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// counters of the memory served to BigInt limb storage
+struct BigIntAllocStats
+{
+	size_t allocations = 0;  // blocks served
+	size_t deallocations = 0;  // blocks given back
+	size_t bytes = 0;  // bytes served, block headers included
+	size_t reserved = 0;  // bytes currently held in chunks
+};
+
+
+// Bump arena for the limbs of BigInt values: blocks are carved from large chunks
+// and released all at once by Reset(). Installed for the current thread with
+// BigIntArenaScope; values created outside any scope use the global heap.
+// Not synchronized: an arena serves one thread at a time.
+class BigIntArena
+{
+public:
+	explicit BigIntArena(size_t chunk_bytes = 64 * 1024);
+	BigIntArena(const BigIntArena&) = delete;
+	BigIntArena& operator=(const BigIntArena&) = delete;
+
+	void* Allocate(size_t bytes);
+	void Deallocate(void* p, size_t bytes);  // only the most recent block is actually reclaimed
+	// drops every block at once, values still holding arena memory must be destroyed before;
+	// the chunks are merged into one so that the next round of the same size needs no new chunk
+	void Reset();
+
+	const BigIntAllocStats& GetStats() const { return m_stats; }
+	static BigIntArena* Current();  // arena of the calling thread, nullptr for the global heap
+
+private:
+	friend class BigIntArenaScope;
+
+	void AddChunk(size_t min_bytes);
+
+private:
+	struct Chunk
+	{
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	std::vector<Chunk> m_chunks;  // the last one is being filled
+	size_t m_used = 0;  // bytes taken from the last chunk
+	size_t m_chunk_bytes;  // size of the next chunk, doubles as chunks are added
+	BigIntAllocStats m_stats;
+};
+
+
+// Makes BigInt storage on the calling thread come from arena for the lifetime of the scope.
+// Scopes nest; copying a value after its scope has ended moves it back to the global heap.
+class BigIntArenaScope
+{
+public:
+	explicit BigIntArenaScope(BigIntArena& arena);
+	~BigIntArenaScope();
+	BigIntArenaScope(const BigIntArenaScope&) = delete;
+	BigIntArenaScope& operator=(const BigIntArenaScope&) = delete;
+
+private:
+	BigIntArena* m_previous;
+};
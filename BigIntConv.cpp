@@ -0,0 +1,481 @@
+#include "BigIntImpl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <vector>
+
+
+// Radix conversion by divide and conquer: a number of n limbs is split at
+// base^(k * 2^j) with that power close to its square root, so both directions cost
+// a few multiplications (or divisions) of every size instead of O(n^2) limb steps.
+// Power-of-two bases need no arithmetic at all: their digits are bit fields.
+// The streaming variants hold the binary value but never the whole text: the digits
+// go out piece by piece, most significant first, and come in by blocks of 9 * 2^j.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	const char DIGIT_CHARS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+	// streamed text is parsed by blocks of 9 * 2^STREAM_BLOCK_LEVEL digits
+	const size_t STREAM_BLOCK_LEVEL = 10;
+	// streamed output is handed to the sink in pieces of about this many characters
+	const size_t STREAM_BUFFER_CHARS = 1 << 16;
+	// values of up to this many limbs are written by WriteChars without allocating
+	const size_t STACK_LIMBS = 16;
+
+
+	// text is converted by chunks of k digits, base^k the largest power of the base fitting in a limb
+	struct Radix
+	{
+		unsigned base;
+		limb_t chunk_base;
+		size_t chunk_digits;
+	};
+
+
+	const Radix& GetRadix(unsigned base)  // 2 <= base <= 36
+	{
+		static const std::vector<Radix> radixes = []
+		{
+			std::vector<Radix> r(37);
+			for (unsigned b = 2; b <= 36; ++b)
+			{
+				r[b] = Radix{ b, b, 1 };
+				while (static_cast<dlimb_t>(r[b].chunk_base) * b <= ~limb_t(0))
+				{
+					r[b].chunk_base *= b;
+					++r[b].chunk_digits;
+				}
+			}
+			return r;
+		}();
+		return radixes[base];
+	}
+
+
+	// by table: digits and letters of random text mispredict the range comparisons
+	unsigned DigitValue(char c)  // 36 for anything but a digit or a letter
+	{
+		static const std::vector<unsigned char> values = []
+		{
+			std::vector<unsigned char> v(256, 36);
+			for (unsigned i = 0; i < 36; ++i)
+			{
+				v[static_cast<unsigned char>(DIGIT_CHARS[i])] = static_cast<unsigned char>(i);
+				if (i >= 10)
+					v[static_cast<unsigned char>(DIGIT_CHARS[i] - 'a' + 'A')] = static_cast<unsigned char>(i);
+			}
+			return v;
+		}();
+		return values[static_cast<unsigned char>(c)];
+	}
+
+
+	unsigned Log2Base(unsigned base)  // bits per digit of a power-of-two base, 0 for the others
+	{
+		if ((base & (base - 1)) != 0)
+			return 0;
+		unsigned k = 0;
+		while ((1u << k) < base)
+			++k;
+		return k;
+	}
+
+
+	size_t ConvThreshold()
+	{
+		// the split power must be at least two limbs wide for DivRem
+		return std::max<size_t>(BigInt::Thresholds().conv_dc, 4);
+	}
+
+
+	// base^(k * 2^j): computed on first use by repeated squaring and kept for the process lifetime
+	const std::vector<limb_t>& RadixPower(const Radix& radix, size_t j)
+	{
+		static std::mutex mutex;
+		static std::deque<std::vector<limb_t>> powers[37];  // deque keeps references valid while growing
+
+		std::lock_guard<std::mutex> lock(mutex);
+		std::deque<std::vector<limb_t>>& p = powers[radix.base];
+		if (p.empty())
+			p.push_back(std::vector<limb_t>(1, radix.chunk_base));
+		while (p.size() <= j)
+		{
+			const std::vector<limb_t>& last = p.back();
+			std::vector<limb_t> square(2 * last.size());
+			Mul(square.data(), last.data(), last.size(), last.data(), last.size());
+			square.resize(Normalized(square.data(), square.size()));
+			p.push_back(square);
+		}
+		return p[j];
+	}
+
+
+	void ParseBasecase(BigIntLimbs& out, const char* digits, size_t n, const Radix& radix)
+	{
+		// x = x * base^k + next chunk of k digits; the first chunk takes the odd remainder
+		out.clear();
+		size_t chunk_len = n % radix.chunk_digits;
+		if (chunk_len == 0)
+			chunk_len = radix.chunk_digits;
+		for (size_t pos = 0; pos < n; pos += chunk_len, chunk_len = radix.chunk_digits)
+		{
+			limb_t chunk = 0;
+			limb_t mul = 1;
+			for (size_t i = 0; i < chunk_len; ++i)
+			{
+				chunk = chunk * radix.base + DigitValue(digits[pos + i]);
+				mul *= radix.base;
+			}
+			limb_t carry = Mul1(out.data(), out.data(), out.size(), mul);
+			carry += Add1(out.data(), out.data(), out.size(), chunk);  // no overflow: x * mul + chunk < B * mul
+			if (carry != 0)
+				out.push_back(carry);
+		}
+		out.resize(Normalized(out.data(), out.size()));
+	}
+
+
+	// high * base^(k * 2^j) + low
+	void Combine(BigIntLimbs& out, const BigIntLimbs& high, const Radix& radix, size_t j, const BigIntLimbs& low)
+	{
+		const std::vector<limb_t>& power = RadixPower(radix, j);
+		BigIntLimbs r;
+		r.assign(high.size() + power.size() + 1, 0);
+		if (!high.empty())
+			Mul(r.data(), high.data(), high.size(), power.data(), power.size());
+		Add(r.data(), r.data(), r.size(), low.data(), low.size());
+		r.resize(Normalized(r.data(), r.size()));
+		out.swap(r);
+	}
+
+
+	void Parse(BigIntLimbs& out, const char* digits, size_t n, const Radix& radix)
+	{
+		if (n < ConvThreshold() * radix.chunk_digits)
+		{
+			ParseBasecase(out, digits, n, radix);
+			return;
+		}
+
+		// value = high * base^L + low with the largest L = k * 2^j below n
+		size_t j = 0;
+		while ((radix.chunk_digits << (j + 1)) < n)
+			++j;
+		size_t low_digits = radix.chunk_digits << j;
+		BigIntLimbs high, low;
+		Parse(high, digits, n - low_digits, radix);
+		Parse(low, digits + n - low_digits, low_digits, radix);
+
+		Combine(out, high, radix, j, low);
+	}
+
+
+	// the digits of a power-of-two base are the k-bit fields of the value, the last digit lowest
+	void ParseBits(BigIntLimbs& out, const char* digits, size_t n, unsigned k)
+	{
+		out.assign((n * k + LIMB_BITS - 1) / LIMB_BITS, 0);
+		limb_t* r = out.data();
+		dlimb_t acc = 0;
+		unsigned acc_bits = 0;
+		for (const char* p = digits + n; p != digits;)
+		{
+			acc |= static_cast<dlimb_t>(DigitValue(*--p)) << acc_bits;
+			acc_bits += k;
+			if (acc_bits >= static_cast<unsigned>(LIMB_BITS))
+			{
+				*r++ = static_cast<limb_t>(acc);
+				acc >>= LIMB_BITS;
+				acc_bits -= LIMB_BITS;
+			}
+		}
+		if (acc_bits > 0)
+			*r = static_cast<limb_t>(acc);
+		out.resize(Normalized(out.data(), out.size()));
+	}
+
+
+	// append exactly width digits (zero padded), or all digits without padding when width == 0;
+	// Out is anything with append(const char*, size_t)
+	template<typename Out>
+	void PrintBasecase(Out& out, const limb_t* a, size_t n, size_t width, const Radix& radix)
+	{
+		std::vector<limb_t> tmp(a, a + n);
+		std::string digits;
+		while (n > 0)
+		{
+			limb_t chunk = DivRem1(tmp.data(), tmp.data(), n, radix.chunk_base);
+			n = Normalized(tmp.data(), n);
+			for (size_t i = 0; i < radix.chunk_digits && (n > 0 || chunk != 0); ++i)
+			{
+				digits.push_back(DIGIT_CHARS[chunk % radix.base]);
+				chunk /= radix.base;
+			}
+		}
+		if (width == 0 && digits.empty())
+			digits.push_back('0');
+		if (digits.size() < width)
+			digits.append(width - digits.size(), '0');
+		std::reverse(digits.begin(), digits.end());
+		out.append(digits.data(), digits.size());
+	}
+
+
+	template<typename Out>
+	void Print(Out& out, const limb_t* a, size_t n, size_t width, const Radix& radix)
+	{
+		n = Normalized(a, n);
+		if (n < ConvThreshold())
+		{
+			PrintBasecase(out, a, n, width, radix);
+			return;
+		}
+
+		// largest power with about half the limbs of a
+		size_t j = 1;
+		while (2 * RadixPower(radix, j + 1).size() <= n + 1)
+			++j;
+		const std::vector<limb_t>& power = RadixPower(radix, j);
+		size_t np = power.size();
+		size_t low_digits = radix.chunk_digits << j;
+
+		std::vector<limb_t> q(n - np + 1);
+		std::vector<limb_t> r(np);
+		DivRem(q.data(), r.data(), a, n, power.data(), np);
+		Print(out, q.data(), q.size(), (width > 0) ? width - low_digits : 0, radix);
+		Print(out, r.data(), r.size(), low_digits, radix);
+	}
+
+
+	// collects the pieces of Print for the sink
+	class BufferedSink
+	{
+	public:
+		explicit BufferedSink(const std::function<void(const char*, size_t)>& sink) : m_sink(sink) {}
+		~BufferedSink() { Flush(); }
+
+		void append(const char* chars, size_t n)
+		{
+			m_buffer.append(chars, n);
+			if (m_buffer.size() >= STREAM_BUFFER_CHARS)
+				Flush();
+		}
+
+		void Flush()
+		{
+			if (!m_buffer.empty())
+				m_sink(m_buffer.data(), m_buffer.size());
+			m_buffer.clear();
+		}
+
+	private:
+		const std::function<void(const char*, size_t)>& m_sink;
+		std::string m_buffer;
+	};
+
+
+	// copies the pieces of Print into [first, last) until one does not fit
+	class CharRange
+	{
+	public:
+		CharRange(char* first, char* last) : m_pos(first), m_last(last) {}
+
+		void append(const char* chars, size_t n)
+		{
+			if (m_pos == nullptr || n > static_cast<size_t>(m_last - m_pos))
+			{
+				m_pos = nullptr;
+				return;
+			}
+			std::memcpy(m_pos, chars, n);
+			m_pos += n;
+		}
+
+		char* End() const { return m_pos; }  // nullptr once a piece did not fit
+
+	private:
+		char* m_pos;
+		char* m_last;
+	};
+
+
+	char* WriteBits(char* first, char* last, const limb_t* a, size_t n, unsigned k)
+	{
+		size_t bits = n * LIMB_BITS - CountLeadingZeros(a[n - 1]);
+		size_t count = (bits + k - 1) / k;
+		if (count > static_cast<size_t>(last - first))
+			return nullptr;
+		const limb_t mask = (limb_t(1) << k) - 1;
+		for (size_t i = 0; i < count; ++i)
+		{
+			// a digit may straddle two limbs
+			size_t bit = i * k;
+			size_t index = bit / LIMB_BITS;
+			dlimb_t w = a[index];
+			if (index + 1 < n)
+				w |= static_cast<dlimb_t>(a[index + 1]) << LIMB_BITS;
+			first[count - 1 - i] = DIGIT_CHARS[(w >> (bit % LIMB_BITS)) & mask];
+		}
+		return first + count;
+	}
+
+
+	// PrintBasecase on the stack: chunks from the low end fill a local buffer from its back
+	char* WriteSmall(char* first, char* last, const limb_t* a, size_t n, const Radix& radix)
+	{
+		limb_t tmp[STACK_LIMBS];
+		char digits[STACK_LIMBS * LIMB_BITS];  // at most one digit per bit
+		std::copy(a, a + n, tmp);
+		char* end = digits + sizeof(digits);
+		char* pos = end;
+		while (n > 0)
+		{
+			limb_t chunk = DivRem1(tmp, tmp, n, radix.chunk_base);
+			n = Normalized(tmp, n);
+			for (size_t i = 0; i < radix.chunk_digits && (n > 0 || chunk != 0); ++i)
+			{
+				*--pos = DIGIT_CHARS[chunk % radix.base];
+				chunk /= radix.base;
+			}
+		}
+		size_t count = end - pos;
+		if (count > static_cast<size_t>(last - first))
+			return nullptr;
+		std::memcpy(first, pos, count);
+		return first + count;
+	}
+}
+
+
+void ParseDecimal(BigIntLimbs& out, const char* digits, size_t n)
+{
+	Parse(out, digits, n, GetRadix(10));
+}
+
+
+void ParseChars(BigIntLimbs& out, const char* digits, size_t n, unsigned base)
+{
+	unsigned k = Log2Base(base);
+	if (k > 0)
+		ParseBits(out, digits, n, k);
+	else
+		Parse(out, digits, n, GetRadix(base));
+}
+
+
+size_t CountDigits(const char* first, const char* last, unsigned base)
+{
+	const char* p = first;
+	while (p != last && DigitValue(*p) < base)
+		++p;
+	return p - first;
+}
+
+
+char* WriteChars(char* first, char* last, const limb_t* a, size_t n, unsigned base)
+{
+	n = Normalized(a, n);
+	if (n == 0)
+	{
+		if (first == last)
+			return nullptr;
+		*first = '0';
+		return first + 1;
+	}
+	unsigned k = Log2Base(base);
+	if (k > 0)
+		return WriteBits(first, last, a, n, k);
+	const Radix& radix = GetRadix(base);
+	if (n <= STACK_LIMBS)
+		return WriteSmall(first, last, a, n, radix);
+	CharRange out(first, last);
+	Print(out, a, n, 0, radix);
+	return out.End();
+}
+
+
+size_t DigitsUpperBound(size_t bits, unsigned base)
+{
+	unsigned k = Log2Base(base);
+	if (k > 0)
+		return std::max<size_t>((bits + k - 1) / k, 1);
+	// bits * log_base(2) truncated, plus one for the truncation and one for rounding errors
+	return static_cast<size_t>(static_cast<double>(bits) * (std::log(2.0) / std::log(static_cast<double>(base)))) + 2;
+}
+
+
+size_t ReadDecimal(BigIntLimbs& out, std::streambuf& in)
+{
+	// full blocks are merged like a binary counter: an entry of level j holds 9 * 2^j
+	// digits, two of the same level make one of the next, so every product is balanced
+	struct Entry
+	{
+		BigIntLimbs value;
+		size_t level;
+	};
+	const Radix& radix = GetRadix(10);
+	std::vector<Entry> stack;
+	const size_t block_digits = radix.chunk_digits << STREAM_BLOCK_LEVEL;
+	std::string block;
+	size_t total = 0;
+	for (;;)
+	{
+		block.clear();
+		for (int c = in.sgetc(); c != std::char_traits<char>::eof() && c >= '0' && c <= '9'; c = in.snextc())
+		{
+			block.push_back(static_cast<char>(c));
+			if (block.size() == block_digits)
+			{
+				in.sbumpc();
+				break;
+			}
+		}
+		total += block.size();
+		if (block.size() < block_digits)
+			break;
+		Entry entry;
+		Parse(entry.value, block.data(), block.size(), radix);
+		entry.level = STREAM_BLOCK_LEVEL;
+		while (!stack.empty() && stack.back().level == entry.level)
+		{
+			Combine(entry.value, stack.back().value, radix, entry.level, entry.value);
+			++entry.level;
+			stack.pop_back();
+		}
+		stack.push_back(std::move(entry));
+	}
+
+	// the entries from the most significant one down, then the partial last block
+	out.clear();
+	for (const Entry& entry : stack)
+		Combine(out, out, radix, entry.level, entry.value);
+	if (!block.empty())
+	{
+		BigIntLimbs tail;
+		Parse(tail, block.data(), block.size(), radix);
+		BigInt value = BigInt::FromLimbs(out.data(), out.size()) * BigInt::Pow(10, block.size()) + BigInt::FromLimbs(tail.data(), tail.size());
+		out.assign(value.GetLimbs().begin(), value.GetLimbs().end());
+	}
+	return total;
+}
+
+
+void AppendDecimal(std::string& out, const limb_t* a, size_t n)
+{
+	Print(out, a, n, 0, GetRadix(10));
+}
+
+
+void WriteDecimal(const limb_t* a, size_t n, const std::function<void(const char*, size_t)>& sink)
+{
+	BufferedSink out(sink);
+	Print(out, a, n, 0, GetRadix(10));
+}
+
+}  // namespace bigint_impl
@@ -0,0 +1,306 @@
+#include "BigIntImpl.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+
+namespace bigint_impl
+{
+
+namespace
+{
+	// two limbs by a limb d with its top bit set, by the reciprocal v = floor((B^2 - 1) / d) - B
+	// computed once: a multiplication and two rare corrections instead of a hardware division
+	// (Moller and Granlund, "Improved division by invariant integers")
+	struct Reciprocal
+	{
+		limb_t d;
+		limb_t v;
+
+		explicit Reciprocal(limb_t normalized) :
+			d(normalized),
+			v(static_cast<limb_t>(~dlimb_t(0) / normalized - (dlimb_t(1) << LIMB_BITS)))
+		{}
+
+		limb_t DivRem(limb_t u1, limb_t u0, limb_t& q) const  // (u1 B + u0) / d for u1 < d, returns the remainder
+		{
+			// the sums wrap modulo B^2 and B, which the corrections expect
+			dlimb_t p = static_cast<dlimb_t>(v) * u1 + ((static_cast<dlimb_t>(u1) << LIMB_BITS) | u0);
+			limb_t q1 = static_cast<limb_t>(p >> LIMB_BITS) + 1;
+			limb_t r = u0 - q1 * d;
+			if (r > static_cast<limb_t>(p))
+			{
+				--q1;
+				r += d;
+			}
+			if (r >= d)
+			{
+				++q1;
+				r -= d;
+			}
+			q = q1;
+			return r;
+		}
+	};
+
+
+	// the dividend is shifted along with the divisor limb by limb; q may be a and is
+	// written behind the reads
+	template<bool STORE>
+	limb_t DivRemNormalized(limb_t* q, const limb_t* a, size_t n, limb_t d)
+	{
+		unsigned shift = CountLeadingZeros(d);
+		Reciprocal inv(d << shift);
+		limb_t r = 0;
+		limb_t digit = 0;
+		if (shift == 0)
+		{
+			for (size_t i = n; i-- > 0;)
+			{
+				r = inv.DivRem(r, a[i], digit);
+				if (STORE)
+					q[i] = digit;
+			}
+			return r;
+		}
+		r = a[n - 1] >> (LIMB_BITS - shift);
+		for (size_t i = n - 1; i > 0; --i)
+		{
+			r = inv.DivRem(r, (a[i] << shift) | (a[i - 1] >> (LIMB_BITS - shift)), digit);
+			if (STORE)
+				q[i] = digit;
+		}
+		r = inv.DivRem(r, a[0] << shift, digit);
+		if (STORE)
+			q[0] = digit;
+		return r >> shift;
+	}
+}
+
+
+limb_t DivRem1(limb_t* q, const limb_t* a, size_t n, limb_t d)
+{
+	assert(d != 0);
+	if (n == 0)
+		return 0;
+	return DivRemNormalized<true>(q, a, n, d);
+}
+
+
+limb_t Mod1(const limb_t* a, size_t n, limb_t d)
+{
+	assert(d != 0);
+	if (n == 0)
+		return 0;
+	return DivRemNormalized<false>(nullptr, a, n, d);
+}
+
+
+// Knuth, TAOCP vol. 2, 4.3.1, Algorithm D: schoolbook division with the divisor
+// normalized so that its top bit is set, which makes the quotient limb estimated
+// from the top two limbs of the remainder at most 2 too large
+void DivRemBasecase(limb_t* q, limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	assert(na >= nb && nb >= 2 && b[nb - 1] != 0);
+	const dlimb_t BASE = dlimb_t(1) << LIMB_BITS;
+
+	// D1: normalize, the dividend gets one extra limb
+	unsigned shift = CountLeadingZeros(b[nb - 1]);
+	std::vector<limb_t> bn(b, b + nb);
+	std::vector<limb_t> an(na + 1);
+	if (shift > 0)
+	{
+		LShift(bn.data(), b, nb, shift);
+		an[na] = LShift(an.data(), a, na, shift);
+	}
+	else
+	{
+		std::copy(a, a + na, an.begin());
+		an[na] = 0;
+	}
+	const limb_t top = bn[nb - 1];
+	const limb_t second = bn[nb - 2];
+
+	for (size_t j = na - nb + 1; j-- > 0;)
+	{
+		// D3: estimate q from the top two limbs, refine it with the third one
+		dlimb_t num = (static_cast<dlimb_t>(an[j + nb]) << LIMB_BITS) | an[j + nb - 1];
+		dlimb_t qhat = num / top;
+		dlimb_t rhat = num % top;
+		while (qhat >= BASE || qhat * second > ((rhat << LIMB_BITS) | an[j + nb - 2]))
+		{
+			--qhat;
+			rhat += top;
+			if (rhat >= BASE)
+				break;
+		}
+
+		// D4: multiply and subtract
+		limb_t borrow = SubMul1(an.data() + j, bn.data(), nb, static_cast<limb_t>(qhat));
+		limb_t high = an[j + nb];
+		an[j + nb] = high - borrow;
+
+		// D6: the estimate was still one too large, add back
+		if (high < borrow)
+		{
+			--qhat;
+			limb_t carry = AddN(an.data() + j, an.data() + j, bn.data(), nb);
+			an[j + nb] += carry;
+		}
+		q[j] = static_cast<limb_t>(qhat);
+	}
+
+	// D8: unnormalize the remainder
+	if (shift > 0)
+		RShift(r, an.data(), nb, shift);
+	else
+		std::copy(an.begin(), an.begin() + nb, r);
+}
+
+
+
+// Burnikel and Ziegler, "Fast Recursive Division" (1998): the quotient is built from
+// half-size subproblems whose cost is dominated by multiplications, so division
+// inherits the Karatsuba/Toom/NTT speed of the multiplication engine
+namespace
+{
+	// tiny thresholds would recurse down to one-limb divisors
+	size_t BzThreshold()
+	{
+		return std::max<size_t>(BigInt::Thresholds().div_bz, 4);
+	}
+
+
+	void Div3n2n(limb_t* q, limb_t* r, const limb_t* a, const limb_t* b, size_t m);
+
+
+	// q (n limbs), r (n limbs) = a (2n limbs) / b (n limbs, top bit set), requires a < b * B^n
+	void Div2n1n(limb_t* q, limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+	{
+		if (n % 2 != 0 || n < BzThreshold())
+		{
+			std::vector<limb_t> qb(n + 1);
+			DivRemBasecase(qb.data(), r, a, 2 * n, b, n);
+			assert(qb[n] == 0);
+			std::copy(qb.begin(), qb.begin() + n, q);
+			return;
+		}
+
+		// a = [A1 A2 A3 A4] in halves: [A1 A2 A3] / b, then [R A4] / b
+		size_t half = n / 2;
+		std::vector<limb_t> r1(n);
+		Div3n2n(q + half, r1.data(), a + half, b, half);
+		std::vector<limb_t> t(3 * half);
+		std::copy(a, a + half, t.begin());
+		std::copy(r1.begin(), r1.end(), t.begin() + half);
+		Div3n2n(q, r, t.data(), b, half);
+	}
+
+
+	// q (m limbs), r (2m limbs) = a (3m limbs) / b (2m limbs, top bit set), requires a < b * B^m
+	void Div3n2n(limb_t* q, limb_t* r, const limb_t* a, const limb_t* b, size_t m)
+	{
+		const limb_t* a1 = a + 2 * m;
+		const limb_t* b1 = b + m;
+
+		// estimate the quotient from the top halves: [A1 A2] / B1, or B^m - 1 when A1 == B1
+		std::vector<limb_t> rh(2 * m + 1, 0);  // [R1 A3] - q * B2, one limb wider for the carry of R1
+		std::copy(a, a + m, rh.begin());
+		if (CmpN(a1, b1, m) < 0)
+		{
+			Div2n1n(q, rh.data() + m, a + m, b1, m);
+		}
+		else
+		{
+			// R1 = [A1 A2] - (B^m - 1) * B1 = [A1 A2] - [B1 0] + B1
+			std::fill(q, q + m, ~limb_t(0));
+			std::vector<limb_t> r1(2 * m + 1, 0);
+			std::copy(a + m, a + 3 * m, r1.begin());
+			Add(r1.data(), r1.data(), 2 * m + 1, b1, m);
+			Sub(r1.data() + m, r1.data() + m, m + 1, b1, m);
+			assert(Normalized(r1.data(), r1.size()) <= m + 1);
+			std::copy(r1.begin(), r1.begin() + m + 1, rh.begin() + m);
+		}
+
+		// R = [R1 A3] - q * B2, the estimate is at most 2 too large
+		std::vector<limb_t> d(2 * m);
+		Mul(d.data(), q, m, b, m);
+		bool negative = Sub(rh.data(), rh.data(), 2 * m + 1, d.data(), 2 * m) != 0;
+		while (negative)
+		{
+			// rh holds R + B^(2m+1); adding b wraps it back once R turns non-negative
+			negative = Add(rh.data(), rh.data(), 2 * m + 1, b, 2 * m) == 0;
+			Sub1(q, q, m, 1);
+		}
+		assert(rh[2 * m] == 0);
+		std::copy(rh.begin(), rh.begin() + 2 * m, r);
+	}
+
+
+	void DivRemBz(limb_t* q, limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		// block size n = j * 2^k with j below the threshold, so that the recursion halves evenly
+		size_t threshold = BzThreshold();
+		size_t mult = 1;
+		while (mult * threshold <= nb)
+			mult *= 2;
+		size_t n = (nb + mult - 1) / mult * mult;
+
+		// shift both operands so that b fills exactly n limbs with its top bit set
+		size_t sigma = n - nb;
+		unsigned shift = CountLeadingZeros(b[nb - 1]);
+		std::vector<limb_t> bs(n, 0);
+		std::vector<limb_t> as;
+		// one spare limb keeps the top bit of the top block clear, so that block is below bs
+		size_t t = std::max<size_t>(2, (na + sigma + 1 + n - 1) / n);
+		as.assign(t * n, 0);
+		if (shift > 0)
+		{
+			LShift(bs.data() + sigma, b, nb, shift);
+			as[sigma + na] = LShift(as.data() + sigma, a, na, shift);
+		}
+		else
+		{
+			std::copy(b, b + nb, bs.begin() + sigma);
+			std::copy(a, a + na, as.begin() + sigma);
+		}
+
+		// schoolbook division in base B^n, every step is a 2n / n limb division
+		std::vector<limb_t> quot((t - 1) * n);
+		std::vector<limb_t> z(as.begin() + (t - 2) * n, as.end());
+		std::vector<limb_t> rem(n);
+		for (size_t i = t - 1; i-- > 0;)
+		{
+			Div2n1n(quot.data() + i * n, rem.data(), z.data(), bs.data(), n);
+			if (i > 0)
+			{
+				std::copy(as.begin() + (i - 1) * n, as.begin() + i * n, z.begin());
+				std::copy(rem.begin(), rem.end(), z.begin() + n);
+			}
+		}
+
+		size_t nq = na - nb + 1;
+		size_t copied = std::min(nq, quot.size());
+		assert(Normalized(quot.data(), quot.size()) <= nq);
+		std::copy(quot.begin(), quot.begin() + copied, q);
+		std::fill(q + copied, q + nq, 0);
+
+		// remainder of the shifted operands is the true remainder shifted the same way
+		if (shift > 0)
+			RShift(r, rem.data() + sigma, nb, shift);
+		else
+			std::copy(rem.begin() + sigma, rem.end(), r);
+	}
+}
+
+
+void DivRem(limb_t* q, limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	size_t threshold = BzThreshold();
+	if (nb >= threshold && na - nb >= threshold)
+		DivRemBz(q, r, a, na, b, nb);
+	else
+		DivRemBasecase(q, r, a, na, b, nb);
+}
+
+}  // namespace bigint_impl
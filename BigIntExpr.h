@@ -0,0 +1,271 @@
+#pragma once
+
+#include "BigInt.h"
+#include <utility>
+
+// Opt-in expression templates: an operand wrapped in BigIntLazy makes +, - and * build a
+// tree instead of computing every step into a temporary, and assigning the tree to a BigInt
+// evaluates it into the storage of that value, products by BigInt::AddMul and SubMul:
+//
+//     r = BigIntLazy(a) * b + BigIntLazy(c) * d - e;  // r = a * b; r += c * d; r -= e
+//     acc = BigIntLazy(acc) * x + coeff[i];  // Horner step in the storage of acc
+//
+// Nodes refer to their operands: evaluate a tree in the statement that builds it and never
+// keep one in an auto variable. Other operations take the tree converted to a BigInt.
+template<typename E>
+class BigIntExpr
+{
+public:
+	const E& Self() const { return static_cast<const E&>(*this); }
+};
+
+
+namespace bigint_expr
+{
+	// Every node E has
+	//     bool Refers(const BigInt& x) const;  // x is an operand somewhere in the tree
+	//     void AssignTo(BigInt& r) const;  // r = value, r may be an operand
+	//     void AddTo(BigInt& r, bool negate) const;  // r += value or r -= value, r is no operand
+	//     template<typename F> void Apply(F f) const;  // f(const BigInt& value)
+
+	// a BigInt by reference
+	class Ref : public BigIntExpr<Ref>
+	{
+	public:
+		explicit Ref(const BigInt& x) : m_x(x) {}
+
+		bool Refers(const BigInt& x) const { return &m_x == &x; }
+		void AssignTo(BigInt& r) const { if (&r != &m_x) r = m_x; }
+		void AddTo(BigInt& r, bool negate) const { if (negate) r -= m_x; else r += m_x; }
+		template<typename F> void Apply(F f) const { f(m_x); }
+
+	private:
+		const BigInt& m_x;
+	};
+
+
+	// a built-in integer, held as a BigInt of at most two limbs that never allocates
+	class Word : public BigIntExpr<Word>
+	{
+	public:
+		template<typename T> explicit Word(T i) : m_x(i) {}
+
+		bool Refers(const BigInt&) const { return false; }
+		void AssignTo(BigInt& r) const { r = m_x; }
+		void AddTo(BigInt& r, bool negate) const { if (negate) r -= m_x; else r += m_x; }
+		template<typename F> void Apply(F f) const { f(m_x); }
+
+	private:
+		BigInt m_x;
+	};
+
+
+	template<typename L, typename R, bool SUBTRACT>
+	class Sum : public BigIntExpr<Sum<L, R, SUBTRACT>>
+	{
+	public:
+		Sum(const L& left, const R& right) : m_left(left), m_right(right) {}
+
+		bool Refers(const BigInt& x) const { return m_left.Refers(x) || m_right.Refers(x); }
+
+		void AssignTo(BigInt& r) const
+		{
+			// r takes one side and accumulates the other, which must not read r any more
+			if (!m_right.Refers(r))
+			{
+				m_left.AssignTo(r);
+				m_right.AddTo(r, SUBTRACT);
+			}
+			else if (!m_left.Refers(r))
+			{
+				m_right.AssignTo(r);
+				if (SUBTRACT)
+					r.Negate();
+				m_left.AddTo(r, false);
+			}
+			else
+			{
+				BigInt value;
+				AssignTo(value);
+				r = std::move(value);
+			}
+		}
+
+		void AddTo(BigInt& r, bool negate) const
+		{
+			m_left.AddTo(r, negate);
+			m_right.AddTo(r, negate != SUBTRACT);
+		}
+
+		template<typename F> void Apply(F f) const
+		{
+			BigInt value;
+			AssignTo(value);
+			f(value);
+		}
+
+	private:
+		L m_left;
+		R m_right;
+	};
+
+
+	template<typename L, typename R>
+	class Product : public BigIntExpr<Product<L, R>>
+	{
+	public:
+		Product(const L& left, const R& right) : m_left(left), m_right(right) {}
+
+		bool Refers(const BigInt& x) const { return m_left.Refers(x) || m_right.Refers(x); }
+
+		void AssignTo(BigInt& r) const
+		{
+			if (!Refers(r))
+			{
+				r = 0;  // keeps the storage for the product
+				AddTo(r, false);
+			}
+			else if (!m_right.Refers(r))
+			{
+				m_left.AssignTo(r);
+				m_right.Apply([&r](const BigInt& b) { r *= b; });
+			}
+			else if (!m_left.Refers(r))
+			{
+				m_right.AssignTo(r);
+				m_left.Apply([&r](const BigInt& a) { r *= a; });
+			}
+			else
+			{
+				BigInt value;
+				AssignTo(value);
+				r = std::move(value);
+			}
+		}
+
+		void AddTo(BigInt& r, bool negate) const
+		{
+			m_left.Apply([&](const BigInt& a)
+			{
+				m_right.Apply([&](const BigInt& b)
+				{
+					if (negate)
+						r.SubMul(a, b);
+					else
+						r.AddMul(a, b);
+				});
+			});
+		}
+
+		template<typename F> void Apply(F f) const
+		{
+			BigInt value;
+			AssignTo(value);
+			f(value);
+		}
+
+	private:
+		L m_left;
+		R m_right;
+	};
+
+
+	template<typename E>
+	class Negation : public BigIntExpr<Negation<E>>
+	{
+	public:
+		explicit Negation(const E& e) : m_e(e) {}
+
+		bool Refers(const BigInt& x) const { return m_e.Refers(x); }
+		void AssignTo(BigInt& r) const { m_e.AssignTo(r); r.Negate(); }
+		void AddTo(BigInt& r, bool negate) const { m_e.AddTo(r, !negate); }
+
+		template<typename F> void Apply(F f) const
+		{
+			BigInt value;
+			AssignTo(value);
+			f(value);
+		}
+
+	private:
+		E m_e;
+	};
+}
+
+
+inline bigint_expr::Ref BigIntLazy(const BigInt& x) { return bigint_expr::Ref(x); }
+
+
+template<typename E>
+BigInt::BigInt(const BigIntExpr<E>& e) :
+	BigInt()
+{
+	e.Self().AssignTo(*this);
+}
+
+
+template<typename E>
+BigInt& BigInt::operator=(const BigIntExpr<E>& e)
+{
+	e.Self().AssignTo(*this);
+	return *this;
+}
+
+
+template<typename E>
+BigInt& BigInt::operator+=(const BigIntExpr<E>& e)
+{
+	if (e.Self().Refers(*this))
+		return *this += BigInt(e);
+	e.Self().AddTo(*this, false);
+	return *this;
+}
+
+
+template<typename E>
+BigInt& BigInt::operator-=(const BigIntExpr<E>& e)
+{
+	if (e.Self().Refers(*this))
+		return *this -= BigInt(e);
+	e.Self().AddTo(*this, true);
+	return *this;
+}
+
+
+// OPERATORS
+// a node with a node, a BigInt or a built-in integer on either side makes a node
+template<typename L, typename R>
+bigint_expr::Sum<L, R, false> operator+(const BigIntExpr<L>& left, const BigIntExpr<R>& right) { return { left.Self(), right.Self() }; }
+template<typename L>
+bigint_expr::Sum<L, bigint_expr::Ref, false> operator+(const BigIntExpr<L>& left, const BigInt& right) { return { left.Self(), bigint_expr::Ref(right) }; }
+template<typename R>
+bigint_expr::Sum<bigint_expr::Ref, R, false> operator+(const BigInt& left, const BigIntExpr<R>& right) { return { bigint_expr::Ref(left), right.Self() }; }
+template<typename L, typename T>
+BigIntIfWord<T, bigint_expr::Sum<L, bigint_expr::Word, false>> operator+(const BigIntExpr<L>& left, T right) { return { left.Self(), bigint_expr::Word(right) }; }
+template<typename T, typename R>
+BigIntIfWord<T, bigint_expr::Sum<bigint_expr::Word, R, false>> operator+(T left, const BigIntExpr<R>& right) { return { bigint_expr::Word(left), right.Self() }; }
+
+template<typename L, typename R>
+bigint_expr::Sum<L, R, true> operator-(const BigIntExpr<L>& left, const BigIntExpr<R>& right) { return { left.Self(), right.Self() }; }
+template<typename L>
+bigint_expr::Sum<L, bigint_expr::Ref, true> operator-(const BigIntExpr<L>& left, const BigInt& right) { return { left.Self(), bigint_expr::Ref(right) }; }
+template<typename R>
+bigint_expr::Sum<bigint_expr::Ref, R, true> operator-(const BigInt& left, const BigIntExpr<R>& right) { return { bigint_expr::Ref(left), right.Self() }; }
+template<typename L, typename T>
+BigIntIfWord<T, bigint_expr::Sum<L, bigint_expr::Word, true>> operator-(const BigIntExpr<L>& left, T right) { return { left.Self(), bigint_expr::Word(right) }; }
+template<typename T, typename R>
+BigIntIfWord<T, bigint_expr::Sum<bigint_expr::Word, R, true>> operator-(T left, const BigIntExpr<R>& right) { return { bigint_expr::Word(left), right.Self() }; }
+
+template<typename L, typename R>
+bigint_expr::Product<L, R> operator*(const BigIntExpr<L>& left, const BigIntExpr<R>& right) { return { left.Self(), right.Self() }; }
+template<typename L>
+bigint_expr::Product<L, bigint_expr::Ref> operator*(const BigIntExpr<L>& left, const BigInt& right) { return { left.Self(), bigint_expr::Ref(right) }; }
+template<typename R>
+bigint_expr::Product<bigint_expr::Ref, R> operator*(const BigInt& left, const BigIntExpr<R>& right) { return { bigint_expr::Ref(left), right.Self() }; }
+template<typename L, typename T>
+BigIntIfWord<T, bigint_expr::Product<L, bigint_expr::Word>> operator*(const BigIntExpr<L>& left, T right) { return { left.Self(), bigint_expr::Word(right) }; }
+template<typename T, typename R>
+BigIntIfWord<T, bigint_expr::Product<bigint_expr::Word, R>> operator*(T left, const BigIntExpr<R>& right) { return { bigint_expr::Word(left), right.Self() }; }
+
+template<typename E>
+bigint_expr::Negation<E> operator-(const BigIntExpr<E>& e) { return bigint_expr::Negation<E>(e.Self()); }
@@ -0,0 +1,163 @@
+#include "BigIntImpl.h"
+#include <algorithm>
+
+
+// Factorials, binomials and primorials from their prime factorizations: the prime powers
+// are packed into 64-bit words and multiplied in a balanced product tree, so that the
+// large products have operands of equal size for the fast multiplication algorithms.
+// The factorial recurses on Luschny's prime swing: n! = ((n / 2)!)^2 * swing(n), with
+// swing(n) = n! / ((n / 2)!)^2 a product of prime powers not exceeding n.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	// products of fewer factors are accumulated one by one
+	const size_t PRODUCT_LEAF = 16;
+
+
+	std::vector<unsigned> PrimesUpTo(unsigned n)
+	{
+		std::vector<unsigned> primes;
+		if (n < 2)
+			return primes;
+		std::vector<bool> composite(size_t(n) + 1, false);
+		for (size_t p = 2; p <= n; ++p)
+		{
+			if (composite[p])
+				continue;
+			primes.push_back(static_cast<unsigned>(p));
+			for (size_t m = p * p; m <= n; m += p)
+				composite[m] = true;
+		}
+		return primes;
+	}
+
+
+	BigInt FromWord(dlimb_t w)
+	{
+		limb_t limbs[2] = { static_cast<limb_t>(w), static_cast<limb_t>(w >> LIMB_BITS) };
+		return BigInt::FromLimbs(limbs, 2);
+	}
+
+
+	BigInt Product(const std::vector<dlimb_t>& words, size_t begin, size_t end)
+	{
+		if (end - begin <= PRODUCT_LEAF)
+		{
+			BigInt r = 1;
+			for (size_t i = begin; i < end; ++i)
+				r *= FromWord(words[i]);
+			return r;
+		}
+		size_t mid = begin + (end - begin) / 2;
+		return Product(words, begin, mid) * Product(words, mid, end);
+	}
+
+
+	// collects factors below 2^32 into 64-bit words for the product tree
+	class Factors
+	{
+	public:
+		void Add(dlimb_t f)
+		{
+			if (m_word > (~dlimb_t(0)) / f)
+			{
+				m_words.push_back(m_word);
+				m_word = 1;
+			}
+			m_word *= f;
+		}
+
+		BigInt Product()
+		{
+			if (m_word > 1)
+				m_words.push_back(m_word);
+			m_word = 1;
+			return bigint_impl::Product(m_words, 0, m_words.size());
+		}
+
+	private:
+		std::vector<dlimb_t> m_words;
+		dlimb_t m_word = 1;
+	};
+
+
+	// swing(n) = n! / ((n / 2)!)^2: p appears to the number of odd quotients n / p^i
+	BigInt Swing(unsigned n, const std::vector<unsigned>& primes)
+	{
+		Factors factors;
+		for (unsigned p : primes)
+		{
+			if (p > n)
+				break;
+			dlimb_t power = 1;
+			for (unsigned q = n / p; q > 0; q /= p)
+				if (q & 1)
+					power *= p;
+			if (power > 1)
+				factors.Add(power);
+		}
+		return factors.Product();
+	}
+
+
+	BigInt Factorial(unsigned n, const std::vector<unsigned>& primes)
+	{
+		if (n <= 20)
+		{
+			dlimb_t f = 1;
+			for (unsigned i = 2; i <= n; ++i)
+				f *= i;
+			return FromWord(f);
+		}
+		BigInt half = Factorial(n / 2, primes);
+		return half * half * Swing(n, primes);
+	}
+}
+
+}  // namespace bigint_impl
+
+
+using namespace bigint_impl;
+
+
+BigInt BigInt::Factorial(unsigned n)
+{
+	return bigint_impl::Factorial(n, PrimesUpTo(n));
+}
+
+
+BigInt BigInt::Binomial(unsigned n, unsigned k)
+{
+	if (k > n)
+		return BigInt();
+	k = std::min(k, n - k);
+	// the power of p in n! / (k! (n - k)!) is the number of borrows in n - k in base p (Kummer),
+	// and p to that power does not exceed n
+	Factors factors;
+	for (unsigned p : PrimesUpTo(n))
+	{
+		dlimb_t power = 1;
+		unsigned borrow = 0;
+		for (unsigned a = n, b = k; a > 0; a /= p, b /= p)
+		{
+			borrow = (a % p < b % p + borrow) ? 1 : 0;
+			if (borrow)
+				power *= p;
+		}
+		if (power > 1)
+			factors.Add(power);
+	}
+	return factors.Product();
+}
+
+
+BigInt BigInt::Primorial(unsigned n)
+{
+	Factors factors;
+	for (unsigned p : PrimesUpTo(n))
+		factors.Add(p);
+	return factors.Product();
+}
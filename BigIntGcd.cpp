@@ -0,0 +1,330 @@
+#include "BigIntImpl.h"
+#include <stdexcept>
+
+
+// Greatest common divisor. Small operands run Lehmer's algorithm: the Euclid steps are
+// decided on the leading 62 bits and applied to the full numbers at once, about 30 bits
+// per pass. Large ones run a recursive half-GCD: the steps that halve a pair are
+// computed from its leading half, recursively, and applied by fast multiplication.
+// Every reduction is recorded as a matrix of the steps, so the Bezout coefficients of
+// the extended GCD come out of the same code.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	// reduction steps as (a, b) = M (a', b'): a product of Euclid steps [q 1; 1 0],
+	// non-negative entries and determinant det = +-1
+	struct Matrix
+	{
+		BigInt m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+		int det = 1;
+
+		bool IsIdentity() const { return m10.IsZero(); }
+
+		void Step(const BigInt& q)  // M = M [q 1; 1 0]
+		{
+			BigInt t = m00 * q + m01;
+			m01 = std::move(m00);
+			m00 = std::move(t);
+			t = m10 * q + m11;
+			m11 = std::move(m10);
+			m10 = std::move(t);
+			det = -det;
+		}
+
+		void Mul(const Matrix& other)  // M = M other
+		{
+			BigInt t0 = m00 * other.m00 + m01 * other.m10;
+			BigInt t1 = m00 * other.m01 + m01 * other.m11;
+			m00 = std::move(t0);
+			m01 = std::move(t1);
+			t0 = m10 * other.m00 + m11 * other.m10;
+			t1 = m10 * other.m01 + m11 * other.m11;
+			m10 = std::move(t0);
+			m11 = std::move(t1);
+			det *= other.det;
+		}
+	};
+
+
+	// a' = u0 a + u1 b, b' = v0 a + v1 b
+	struct Cofactors
+	{
+		int64_t u0, u1, v0, v1;
+	};
+
+	const int64_t COFACTOR_LIMIT = 0x7fffffff;  // fits a limb and an int
+
+
+	dlimb_t LimbAt(const BigIntLimbs& limbs, size_t i)
+	{
+		return (i < limbs.size()) ? limbs[i] : 0;
+	}
+
+
+	// bits [shift, shift + 64) of x
+	uint64_t Leading(const BigInt& x, size_t shift)
+	{
+		const BigIntLimbs& limbs = x.GetLimbs();
+		size_t i = shift / LIMB_BITS;
+		unsigned offset = shift % LIMB_BITS;
+		dlimb_t w = LimbAt(limbs, i) | (LimbAt(limbs, i + 1) << LIMB_BITS);
+		if (offset > 0)
+			w = (w >> offset) | (LimbAt(limbs, i + 2) << (2 * LIMB_BITS - offset));
+		return w;
+	}
+
+
+	// u x - v y for x, y >= 0 and a non-negative result
+	BigInt MulSub(const BigInt& x, limb_t u, const BigInt& y, limb_t v)
+	{
+		const BigIntLimbs& xl = x.GetLimbs();
+		const BigIntLimbs& yl = y.GetLimbs();
+		size_t n = std::max(xl.size(), yl.size());
+		std::vector<limb_t> r(n + 1, 0);
+		r[xl.size()] = Mul1(r.data(), xl.data(), xl.size(), u);
+		limb_t borrow = SubMul1(r.data(), yl.data(), yl.size(), v);
+		Sub1(r.data() + yl.size(), r.data() + yl.size(), n + 1 - yl.size(), borrow);
+		return BigInt::FromLimbs(r.data(), n + 1);
+	}
+
+
+	// u x + v y for cofactors of opposite signs
+	BigInt Combine(int64_t u, const BigInt& x, int64_t v, const BigInt& y)
+	{
+		if (u <= 0)
+			return MulSub(y, static_cast<limb_t>(v), x, static_cast<limb_t>(-u));
+		return MulSub(x, static_cast<limb_t>(u), y, static_cast<limb_t>(-v));
+	}
+
+
+	// Lehmer's cofactors (Knuth 4.5.2, Algorithm L) from the leading 62 bits of a >= b > 0:
+	// the steps are those of the full numbers, taken while the remainders stay at least 2^s
+	// (non-zero for s == 0); false when not even one step is certain
+	bool LehmerCofactors(const BigInt& a, const BigInt& b, size_t s, Cofactors& c)
+	{
+		size_t n = a.BitLength();
+		size_t shift = (n > 62) ? n - 62 : 0;
+		if (s >= shift + 60)
+			return false;
+		// a full remainder differs from its leading bits by less than COFACTOR_LIMIT * 2^shift
+		int64_t low = ((s > shift) ? int64_t(1) << (s - shift) : 1) + ((shift > 0) ? COFACTOR_LIMIT : 0);
+		int64_t x = static_cast<int64_t>(Leading(a, shift));
+		int64_t y = static_cast<int64_t>(Leading(b, shift));
+		int64_t u0 = 1, u1 = 0, v0 = 0, v1 = 1;
+		while (y + v0 > 0 && y + v1 > 0)
+		{
+			// the quotient of the full numbers lies between these two
+			int64_t q = (x + u0) / (y + v0);
+			if (q != (x + u1) / (y + v1) || q > COFACTOR_LIMIT)
+				break;
+			int64_t t0 = u0 - q * v0;
+			int64_t t1 = u1 - q * v1;
+			int64_t r = x - q * y;
+			if (t0 > COFACTOR_LIMIT || t0 < -COFACTOR_LIMIT || t1 > COFACTOR_LIMIT || t1 < -COFACTOR_LIMIT || r < low)
+				break;
+			u0 = v0;
+			u1 = v1;
+			v0 = t0;
+			v1 = t1;
+			x = y;
+			y = r;
+		}
+		c = Cofactors{ u0, u1, v0, v1 };
+		return u1 != 0;
+	}
+
+
+	// one Euclid step (a, b) = (b, a mod b), unless the remainder drops below 2^s
+	bool DivStep(BigInt& a, BigInt& b, size_t s, Matrix* m)
+	{
+		BigInt q, r;
+		BigInt::DivMod(a, b, q, r);
+		if (r.BitLength() <= s)
+			return false;
+		a = std::move(b);
+		b = std::move(r);
+		if (m)
+			m->Step(q);
+		return true;
+	}
+
+
+	// Euclid steps on a >= b as long as the remainder stays at least 2^s (non-zero for s == 0)
+	void LehmerReduce(BigInt& a, BigInt& b, size_t s, Matrix* m)
+	{
+		Cofactors c;
+		while (b.BitLength() > s)
+		{
+			if (!LehmerCofactors(a, b, s, c))
+			{
+				if (!DivStep(a, b, s, m))
+					return;
+				continue;
+			}
+			BigInt t = Combine(c.u0, a, c.u1, b);
+			b = Combine(c.v0, a, c.v1, b);
+			a = std::move(t);
+			if (m)
+			{
+				// the inverse of the cofactor matrix
+				Matrix step;
+				step.m00 = static_cast<int>(c.v1 < 0 ? -c.v1 : c.v1);
+				step.m01 = static_cast<int>(c.u1 < 0 ? -c.u1 : c.u1);
+				step.m10 = static_cast<int>(c.v0 < 0 ? -c.v0 : c.v0);
+				step.m11 = static_cast<int>(c.u0 < 0 ? -c.u0 : c.u0);
+				step.det = (c.u0 * c.v1 - c.u1 * c.v0 > 0) ? 1 : -1;
+				m->Mul(step);
+			}
+		}
+	}
+
+
+	// (a, b) = M^-1 (a, b) when that is still a reduction of the full numbers: a > b >= 0
+	bool ApplyInverse(BigInt& a, BigInt& b, const Matrix& m)
+	{
+		BigInt ra = m.m11 * a - m.m01 * b;
+		BigInt rb = m.m00 * b - m.m10 * a;
+		if (m.det < 0)
+		{
+			ra.Negate();
+			rb.Negate();
+		}
+		if (rb.GetSign() || !(rb < ra))
+			return false;
+		a = std::move(ra);
+		b = std::move(rb);
+		return true;
+	}
+
+
+	// Euclid steps on a >= b as long as the remainder stays at least 2^s, subquadratic:
+	// the steps that take a down to t bits follow from the leading 2 (n - t) bits of
+	// n-bit operands alone. Targets deeper than n / 3 bits below the top go through 3n / 4
+	// first, so both recursive halves work on about n / 2 bits (Moller's half-GCD).
+	void ReduceAbove(BigInt& a, BigInt& b, size_t s, Matrix* m)
+	{
+		const size_t small = BigInt::Thresholds().gcd_hgcd * LIMB_BITS;
+		while (b.BitLength() > s)
+		{
+			size_t n = a.BitLength();
+			if (n < small || n - s < small / 2)
+			{
+				LehmerReduce(a, b, s, m);
+				return;
+			}
+			size_t target = (3 * (n - s) <= n) ? s : n - n / 4;
+			size_t p = 2 * target - n;
+			BigInt ah = a >> p;
+			BigInt bh = b >> p;
+			Matrix top;
+			ReduceAbove(ah, bh, ah.BitLength() / 2 + 1, &top);
+			// steps whose remainders stay above the square root of the leading part are
+			// steps of the full numbers too; check it rather than trust it
+			if (!top.IsIdentity() && ApplyInverse(a, b, top))
+			{
+				if (m)
+					m->Mul(top);
+			}
+			else if (!DivStep(a, b, s, m))
+			{
+				return;
+			}
+		}
+	}
+
+
+	// reduces a >= b >= 0 to (Gcd, 0)
+	void Euclid(BigInt& a, BigInt& b, Matrix* m)
+	{
+		const size_t small = BigInt::Thresholds().gcd_hgcd;
+		while (!b.IsZero())
+		{
+			size_t n = a.BitLength();
+			if (b.GetNumLimbs() < small)
+				LehmerReduce(a, b, 0, m);  // b divides a now
+			else if (b.BitLength() > n / 2 + 1)
+				ReduceAbove(a, b, n / 2 + 1, m);  // a mod b has at most n / 2 + 1 bits now
+			BigInt q, r;
+			BigInt::DivMod(a, b, q, r);
+			a = std::move(b);
+			b = std::move(r);
+			if (m)
+				m->Step(q);
+		}
+	}
+}
+
+}  // namespace bigint_impl
+
+
+using namespace bigint_impl;
+
+
+BigInt BigInt::Gcd(const BigInt& a, const BigInt& b)
+{
+	BigInt u = a.Abs();
+	BigInt v = b.Abs();
+	if (CompareAbs(u, v) < 0)
+		std::swap(u, v);
+	if (u.GetNumLimbs() <= 2)
+	{
+		dlimb_t x = LimbAt(u.m_limbs, 0) | (LimbAt(u.m_limbs, 1) << LIMB_BITS);
+		dlimb_t y = LimbAt(v.m_limbs, 0) | (LimbAt(v.m_limbs, 1) << LIMB_BITS);
+		while (y != 0)
+		{
+			dlimb_t t = x % y;
+			x = y;
+			y = t;
+		}
+		limb_t r[2] = { static_cast<limb_t>(x), static_cast<limb_t>(x >> LIMB_BITS) };
+		return FromLimbs(r, 2);
+	}
+	Euclid(u, v, nullptr);
+	return u;
+}
+
+
+BigInt BigInt::ExtendedGcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y)
+{
+	bool swapped = CompareAbs(a, b) < 0;
+	BigInt u = swapped ? b.Abs() : a.Abs();
+	BigInt v = swapped ? a.Abs() : b.Abs();
+	Matrix m;
+	Euclid(u, v, &m);
+	// (|a|, |b|) = M (g, 0), so g = det (m11 |a| - m01 |b|)
+	BigInt xu = std::move(m.m11);
+	BigInt xv = -std::move(m.m01);
+	if (m.det < 0)
+	{
+		xu.Negate();
+		xv.Negate();
+	}
+	x = swapped ? std::move(xv) : std::move(xu);
+	y = swapped ? std::move(xu) : std::move(xv);
+	if (a.GetSign())
+		x.Negate();
+	if (b.GetSign())
+		y.Negate();
+	return u;
+}
+
+
+BigInt BigInt::ModInverse(const BigInt& a, const BigInt& mod)
+{
+	if (mod.IsZero())
+		throw std::domain_error("BigInt: ModInverse with zero modulus");
+	BigInt n = mod.Abs();
+	BigInt r = a % n;
+	if (r.GetSign())
+		r += n;
+	BigInt x, y;
+	if (ExtendedGcd(r, n, x, y) != 1)
+		throw std::domain_error("BigInt: ModInverse of a value not coprime to the modulus");
+	x %= n;
+	if (x.GetSign())
+		x += n;
+	return x;
+}
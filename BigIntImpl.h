@@ -0,0 +1,132 @@
+#pragma once
+
+// Internal limb-span routines shared by the BigInt translation units.
+// A span is a little-endian array of limbs given by pointer and length.
+// Unless stated otherwise the result span must not overlap the operands.
+
+#include "BigInt.h"
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bigint_impl
+{
+	typedef BigInt::limb_t limb_t;
+	typedef BigInt::dlimb_t dlimb_t;
+	const int LIMB_BITS = BigInt::LIMB_BITS;
+
+	// kernels (BigIntKernels.cpp)
+	size_t Normalized(const limb_t* a, size_t n);  // length without heading zero limbs
+	int CmpN(const limb_t* a, const limb_t* b, size_t n);  // sign of a - b
+	int Cmp(const limb_t* a, size_t na, const limb_t* b, size_t nb);  // operands without heading zeroes
+	limb_t AddN(limb_t* r, const limb_t* a, const limb_t* b, size_t n);  // r = a + b, returns carry; r may be a or b
+	limb_t SubN(limb_t* r, const limb_t* a, const limb_t* b, size_t n);  // r = a - b, returns borrow; r may be a or b
+	limb_t Add1(limb_t* r, const limb_t* a, size_t n, limb_t b);  // r = a + b, returns carry; r may be a
+	limb_t Sub1(limb_t* r, const limb_t* a, size_t n, limb_t b);  // r = a - b, returns borrow; r may be a
+	limb_t Add(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);  // na >= nb, r has na limbs
+	limb_t Sub(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);  // na >= nb, r has na limbs
+	limb_t Mul1(limb_t* r, const limb_t* a, size_t n, limb_t b);  // r = a * b, returns high limb; r may be a
+	limb_t AddMul1(limb_t* r, const limb_t* a, size_t n, limb_t b);  // r += a * b, returns carry
+	limb_t SubMul1(limb_t* r, const limb_t* a, size_t n, limb_t b);  // r -= a * b, returns borrow
+	limb_t LShift(limb_t* r, const limb_t* a, size_t n, unsigned shift);  // 0 < shift < LIMB_BITS, returns bits shifted out; r may be a
+	limb_t RShift(limb_t* r, const limb_t* a, size_t n, unsigned shift);  // 0 < shift < LIMB_BITS, returns bits shifted out (high end); r may be a
+
+	inline int CountLeadingZeros(limb_t x)  // x != 0
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_clz(x);
+#else
+		int n = 0;
+		for (limb_t bit = limb_t(1) << (LIMB_BITS - 1); (x & bit) == 0; bit >>= 1)
+			++n;
+		return n;
+#endif
+	}
+
+	inline int CountTrailingZeros(limb_t x)  // x != 0
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctz(x);
+#else
+		int n = 0;
+		for (; (x & 1) == 0; x >>= 1)
+			++n;
+		return n;
+#endif
+	}
+
+	inline int PopCount(limb_t x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcount(x);
+#else
+		x = x - ((x >> 1) & 0x55555555u);
+		x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+		x = (x + (x >> 4)) & 0x0f0f0f0fu;
+		return static_cast<int>((x * 0x01010101u) >> 24);
+#endif
+	}
+
+	// multiplication engine (BigIntMul.cpp)
+	void MulBasecase(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);
+	void Mul(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);  // r has na + nb limbs
+
+	// division (BigIntDiv.cpp)
+	limb_t DivRem1(limb_t* q, const limb_t* a, size_t n, limb_t d);  // q = a / d, returns a % d; q may be a
+	limb_t Mod1(const limb_t* a, size_t n, limb_t d);  // a % d
+	// q = a / b (na - nb + 1 limbs), r = a % b (nb limbs); requires na >= nb >= 2 and b[nb - 1] != 0
+	void DivRem(limb_t* q, limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);
+	void DivRemBasecase(limb_t* q, limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);  // same, always Algorithm D
+
+	// radix conversion (BigIntConv.cpp); bases are 2..36, digits '0'..'9' then letters of either case
+	void ParseDecimal(BigIntLimbs& out, const char* digits, size_t n);  // digits are '0'..'9'
+	void ParseChars(BigIntLimbs& out, const char* digits, size_t n, unsigned base);  // n digits of the base
+	size_t CountDigits(const char* first, const char* last, unsigned base);  // digits of the base at the start of [first, last)
+	// the digits of a in lower case from first, returns their end or nullptr when they do not fit;
+	// values of up to 16 limbs and power-of-two bases allocate nothing
+	char* WriteChars(char* first, char* last, const limb_t* a, size_t n, unsigned base);
+	size_t DigitsUpperBound(size_t bits, unsigned base);  // digits of any value below 2^bits, at least 1
+	void AppendDecimal(std::string& out, const limb_t* a, size_t n);
+	size_t ReadDecimal(BigIntLimbs& out, std::streambuf& in);  // digits up to the first non-digit, returns their count
+	void WriteDecimal(const limb_t* a, size_t n, const std::function<void(const char*, size_t)>& sink);
+
+	// number-theoretic transform multiplication (BigIntNtt.cpp)
+	bool NttFits(size_t na, size_t nb);  // false when the product is too long for the transform primes
+	void MulNtt(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb);
+
+	// fork-join parallelism over the process-wide work-stealing pool (BigIntParallel.cpp);
+	// with a single thread (the default) every task runs inline on the caller
+	size_t NumThreads();
+	void SetNumThreads(size_t n);  // n == 0: one per hardware thread
+	bool UseThreads(size_t nb);  // true when a product whose shorter operand has nb limbs should be split over threads
+
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup(bool parallel = true) : m_parallel(parallel), m_pending(0) {}  // !parallel: Run() calls inline
+		~TaskGroup();  // waits, dropping exceptions
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		void Run(std::function<void()> task);
+		void Wait();  // the caller runs queued tasks while waiting; rethrows the first exception of a task
+
+	private:
+		friend class ThreadPool;
+		void Finish(std::exception_ptr error);
+
+	private:
+		bool m_parallel;
+		std::atomic<size_t> m_pending;
+		std::mutex m_mutex;
+		std::exception_ptr m_error;
+	};
+
+	// body(lo, hi) over subranges of [begin, end) of at least grain indices, in parallel
+	void ParallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+}
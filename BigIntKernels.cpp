@@ -0,0 +1,322 @@
+#include "BigIntImpl.h"
+#include <cstring>
+
+// x86-64: add/sub run on two limbs at a time with the 64-bit add-with-carry
+// instructions, comparison scans 8 limbs per step with AVX2 when the CPU has it
+#if defined(_M_X64) || defined(__x86_64__)
+#define BIGINT_X86_64
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(BIGINT_X86_64) && (defined(_MSC_VER) || defined(__GNUC__))
+#define BIGINT_AVX2
+#ifdef _MSC_VER
+#define BIGINT_TARGET_AVX2
+#else
+#define BIGINT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+
+namespace bigint_impl
+{
+
+namespace
+{
+#ifdef BIGINT_X86_64
+	typedef unsigned long long word_t;  // two limbs, the low one first as x86 is little-endian
+
+	word_t LoadWord(const limb_t* p)
+	{
+		word_t w;
+		std::memcpy(&w, p, sizeof(w));
+		return w;
+	}
+
+
+	void StoreWord(limb_t* p, word_t w)
+	{
+		std::memcpy(p, &w, sizeof(w));
+	}
+#endif
+
+
+	int CmpNPortable(const limb_t* a, const limb_t* b, size_t n)
+	{
+		for (size_t i = n; i-- > 0;)
+		{
+			if (a[i] != b[i])
+				return (a[i] < b[i]) ? -1 : 1;
+		}
+		return 0;
+	}
+
+
+#ifdef BIGINT_AVX2
+	BIGINT_TARGET_AVX2
+	int CmpNAvx2(const limb_t* a, const limb_t* b, size_t n)
+	{
+		// from the top, 8 limbs per step until a block differs
+		size_t i = n;
+		for (; i >= 8; i -= 8)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 8));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i - 8));
+			unsigned equal = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y))));
+			if (equal != 0xFF)
+				return CmpNPortable(a + i - 8, b + i - 8, 8);
+		}
+		return CmpNPortable(a, b, i);
+	}
+
+
+	bool HasAvx2()
+	{
+#ifdef _MSC_VER
+		// AVX2 needs the CPU feature and the OS saving the ymm registers
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+
+	typedef int (*CmpNFunc)(const limb_t* a, const limb_t* b, size_t n);
+
+
+	CmpNFunc SelectCmpN()
+	{
+#ifdef BIGINT_AVX2
+		if (HasAvx2())
+			return CmpNAvx2;
+#endif
+		return CmpNPortable;
+	}
+}
+
+
+size_t Normalized(const limb_t* a, size_t n)
+{
+	while (n > 0 && a[n - 1] == 0)
+		--n;
+	return n;
+}
+
+
+int CmpN(const limb_t* a, const limb_t* b, size_t n)
+{
+	// random operands mostly differ in the top limb: settle that before dispatching
+	if (n == 0)
+		return 0;
+	if (a[n - 1] != b[n - 1])
+		return (a[n - 1] < b[n - 1]) ? -1 : 1;
+	static const CmpNFunc impl = SelectCmpN();
+	return impl(a, b, n - 1);
+}
+
+
+int Cmp(const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	if (na != nb)
+		return (na < nb) ? -1 : 1;
+	return CmpN(a, b, na);
+}
+
+
+limb_t AddN(limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+{
+#ifdef BIGINT_X86_64
+	unsigned char c = 0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		word_t s0, s1;
+		word_t a0 = LoadWord(a + i), a1 = LoadWord(a + i + 2);
+		word_t b0 = LoadWord(b + i), b1 = LoadWord(b + i + 2);
+		c = _addcarry_u64(c, a0, b0, &s0);
+		c = _addcarry_u64(c, a1, b1, &s1);
+		StoreWord(r + i, s0);
+		StoreWord(r + i + 2, s1);
+	}
+	for (; i < n; ++i)
+	{
+		unsigned int s;
+		c = _addcarry_u32(c, a[i], b[i], &s);
+		r[i] = s;
+	}
+	return c;
+#else
+	dlimb_t carry = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		dlimb_t sum = static_cast<dlimb_t>(a[i]) + b[i] + carry;
+		r[i] = static_cast<limb_t>(sum);
+		carry = sum >> LIMB_BITS;
+	}
+	return static_cast<limb_t>(carry);
+#endif
+}
+
+
+limb_t SubN(limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+{
+#ifdef BIGINT_X86_64
+	unsigned char c = 0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		word_t d0, d1;
+		word_t a0 = LoadWord(a + i), a1 = LoadWord(a + i + 2);
+		word_t b0 = LoadWord(b + i), b1 = LoadWord(b + i + 2);
+		c = _subborrow_u64(c, a0, b0, &d0);
+		c = _subborrow_u64(c, a1, b1, &d1);
+		StoreWord(r + i, d0);
+		StoreWord(r + i + 2, d1);
+	}
+	for (; i < n; ++i)
+	{
+		unsigned int d;
+		c = _subborrow_u32(c, a[i], b[i], &d);
+		r[i] = d;
+	}
+	return c;
+#else
+	limb_t borrow = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		// wraps around to the high half when the difference is negative
+		dlimb_t sub = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+		r[i] = static_cast<limb_t>(sub);
+		borrow = (sub >> LIMB_BITS) ? 1 : 0;
+	}
+	return borrow;
+#endif
+}
+
+
+limb_t Add1(limb_t* r, const limb_t* a, size_t n, limb_t b)
+{
+	size_t i = 0;
+	for (; i < n && b != 0; ++i)
+	{
+		r[i] = a[i] + b;
+		b = (r[i] < b) ? 1 : 0;
+	}
+	if (r != a)
+	{
+		for (; i < n; ++i)
+			r[i] = a[i];
+	}
+	return b;
+}
+
+
+limb_t Sub1(limb_t* r, const limb_t* a, size_t n, limb_t b)
+{
+	size_t i = 0;
+	for (; i < n && b != 0; ++i)
+	{
+		limb_t x = a[i];
+		r[i] = x - b;
+		b = (x < b) ? 1 : 0;
+	}
+	if (r != a)
+	{
+		for (; i < n; ++i)
+			r[i] = a[i];
+	}
+	return b;
+}
+
+
+limb_t Add(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	limb_t carry = AddN(r, a, b, nb);
+	return Add1(r + nb, a + nb, na - nb, carry);
+}
+
+
+limb_t Sub(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	limb_t borrow = SubN(r, a, b, nb);
+	return Sub1(r + nb, a + nb, na - nb, borrow);
+}
+
+
+limb_t Mul1(limb_t* r, const limb_t* a, size_t n, limb_t b)
+{
+	dlimb_t carry = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		dlimb_t t = static_cast<dlimb_t>(a[i]) * b + carry;
+		r[i] = static_cast<limb_t>(t);
+		carry = t >> LIMB_BITS;
+	}
+	return static_cast<limb_t>(carry);
+}
+
+
+limb_t AddMul1(limb_t* r, const limb_t* a, size_t n, limb_t b)
+{
+	dlimb_t carry = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		// a[i] * b + r[i] + carry never exceeds 2^64 - 1
+		dlimb_t t = static_cast<dlimb_t>(a[i]) * b + r[i] + carry;
+		r[i] = static_cast<limb_t>(t);
+		carry = t >> LIMB_BITS;
+	}
+	return static_cast<limb_t>(carry);
+}
+
+
+limb_t SubMul1(limb_t* r, const limb_t* a, size_t n, limb_t b)
+{
+	dlimb_t borrow = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		dlimb_t t = static_cast<dlimb_t>(a[i]) * b + borrow;
+		limb_t low = static_cast<limb_t>(t);
+		limb_t x = r[i];
+		r[i] = x - low;
+		borrow = (t >> LIMB_BITS) + ((x < low) ? 1 : 0);
+	}
+	return static_cast<limb_t>(borrow);
+}
+
+
+limb_t LShift(limb_t* r, const limb_t* a, size_t n, unsigned shift)
+{
+	// walk from the top so that r may be a
+	limb_t out = (n > 0) ? (a[n - 1] >> (LIMB_BITS - shift)) : 0;
+	for (size_t i = n; i-- > 0;)
+		r[i] = (a[i] << shift) | ((i > 0) ? (a[i - 1] >> (LIMB_BITS - shift)) : 0);
+	return out;
+}
+
+
+limb_t RShift(limb_t* r, const limb_t* a, size_t n, unsigned shift)
+{
+	limb_t out = (n > 0) ? (a[0] << (LIMB_BITS - shift)) : 0;
+	for (size_t i = 0; i < n; ++i)
+		r[i] = (a[i] >> shift) | ((i + 1 < n) ? (a[i + 1] << (LIMB_BITS - shift)) : 0);
+	return out;
+}
+
+}  // namespace bigint_impl
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// Limb array of BigInt: a std::vector-like container that keeps up to
+// INLINE_LIMBS limbs inside the object and moves to the heap only when a value
+// outgrows them, so values up to 128 bits never allocate.
+class BigIntLimbs
+{
+public:
+	typedef uint32_t limb_t;
+	static const size_t INLINE_LIMBS = 4;
+
+	BigIntLimbs() :
+		m_size(0),
+		m_capacity(INLINE_LIMBS)
+	{}
+
+	BigIntLimbs(const BigIntLimbs& other) :
+		BigIntLimbs()
+	{
+		assign(other.begin(), other.end());
+	}
+
+	BigIntLimbs(BigIntLimbs&& other) noexcept :
+		BigIntLimbs()
+	{
+		swap(other);
+	}
+
+	BigIntLimbs(const limb_t* first, const limb_t* last) :
+		BigIntLimbs()
+	{
+		assign(first, last);
+	}
+
+	~BigIntLimbs()
+	{
+		if (!IsInline())
+			Deallocate(m_storage.heap, m_capacity);
+	}
+
+	BigIntLimbs& operator=(const BigIntLimbs& other)
+	{
+		if (this != &other)
+			assign(other.begin(), other.end());
+		return *this;
+	}
+
+	BigIntLimbs& operator=(BigIntLimbs&& other) noexcept
+	{
+		if (this != &other)
+		{
+			swap(other);
+			other.clear();  // other keeps the old buffer for reuse
+		}
+		return *this;
+	}
+
+	// element access
+	limb_t* data() { return IsInline() ? m_storage.inline_limbs : m_storage.heap; }
+	const limb_t* data() const { return IsInline() ? m_storage.inline_limbs : m_storage.heap; }
+	limb_t& operator[](size_t i) { return data()[i]; }
+	const limb_t& operator[](size_t i) const { return data()[i]; }
+	limb_t& back() { return data()[m_size - 1]; }
+	const limb_t& back() const { return data()[m_size - 1]; }
+	limb_t* begin() { return data(); }
+	limb_t* end() { return data() + m_size; }
+	const limb_t* begin() const { return data(); }
+	const limb_t* end() const { return data() + m_size; }
+
+	// capacity
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	size_t capacity() const { return m_capacity; }
+	bool IsInline() const { return m_capacity == INLINE_LIMBS; }
+
+	void reserve(size_t n)
+	{
+		if (n > m_capacity)
+			Reallocate(n);
+	}
+
+	// modifiers
+	void clear() { m_size = 0; }
+	void pop_back() { --m_size; }
+
+	void push_back(limb_t x)
+	{
+		if (m_size == m_capacity)
+			Reallocate(2 * m_capacity);
+		data()[m_size++] = x;
+	}
+
+	void resize(size_t n, limb_t value = 0)  // new limbs are set to value
+	{
+		reserve(n);
+		limb_t* p = data();
+		for (size_t i = m_size; i < n; ++i)
+			p[i] = value;
+		m_size = n;
+	}
+
+	void assign(size_t n, limb_t value)
+	{
+		m_size = 0;
+		resize(n, value);
+	}
+
+	void assign(const limb_t* first, const limb_t* last)  // the range must not point into *this
+	{
+		size_t n = static_cast<size_t>(last - first);
+		m_size = 0;
+		reserve(n);
+		if (n > 0)
+			std::memmove(data(), first, n * sizeof(limb_t));
+		m_size = n;
+	}
+
+	void swap(BigIntLimbs& other) noexcept
+	{
+		std::swap(m_storage, other.m_storage);
+		std::swap(m_size, other.m_size);
+		std::swap(m_capacity, other.m_capacity);
+	}
+
+private:
+	void Reallocate(size_t capacity)
+	{
+		// growing at least geometrically keeps push_back amortized O(1)
+		if (capacity < 2 * m_capacity)
+			capacity = 2 * m_capacity;
+		limb_t* p = Allocate(capacity);
+		if (m_size > 0)
+			std::memcpy(p, data(), m_size * sizeof(limb_t));
+		if (!IsInline())
+			Deallocate(m_storage.heap, m_capacity);
+		m_storage.heap = p;
+		m_capacity = capacity;
+	}
+
+	// from the calling thread's BigIntArena if one is installed, else from the global heap (BigIntArena.cpp)
+	static limb_t* Allocate(size_t n);
+	static void Deallocate(limb_t* p, size_t n);
+
+private:
+	union Storage
+	{
+		limb_t* heap;  // capacity > INLINE_LIMBS
+		limb_t inline_limbs[INLINE_LIMBS];  // capacity == INLINE_LIMBS
+	};
+
+	Storage m_storage;
+	size_t m_size;
+	size_t m_capacity;
+};
@@ -0,0 +1,350 @@
+#include "BigIntModular.h"
+#include "BigIntImpl.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+// Modular exponentiation: left-to-right sliding windows over the odd powers of the
+// base, with the products reduced by Montgomery multiplication for odd moduli and by
+// Barrett reduction for even ones; both avoid a long division per product.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	typedef std::vector<limb_t> Limbs;
+
+
+	// -n0^-1 mod 2^32 for odd n0
+	limb_t NegInverse(limb_t n0)
+	{
+		limb_t inv = n0;  // n0 * n0 == 1 mod 8: 3 correct bits
+		for (int i = 0; i < 4; ++i)
+			inv *= 2 - n0 * inv;  // every Newton step doubles the correct bits
+		return 0 - inv;
+	}
+
+
+	// r = a * b / R mod n for a, b < n of k limbs, R = B^k
+	class MontgomeryReducer
+	{
+	public:
+		MontgomeryReducer(const limb_t* n, size_t k, limb_t n_inv) :
+			m_n(n),
+			m_k(k),
+			m_n_inv(n_inv),
+			m_t(2 * k + 1)
+		{}
+
+		size_t Size() const { return m_k; }
+
+		void Mul(limb_t* r, const limb_t* a, const limb_t* b)  // r may be a or b
+		{
+			bigint_impl::Mul(m_t.data(), a, m_k, b, m_k);
+			m_t[2 * m_k] = 0;
+			Reduce(r);
+		}
+
+		void Reduce(limb_t* r, const limb_t* a)  // r = a / R mod n
+		{
+			std::fill(m_t.begin(), m_t.end(), 0);
+			std::copy(a, a + m_k, m_t.begin());
+			Reduce(r);
+		}
+
+	private:
+		// r = t / R mod n for t < n * R held in m_t
+		void Reduce(limb_t* r)
+		{
+			size_t k = m_k;
+			limb_t* t = m_t.data();
+			// clear the low limbs one by one with multiples of n
+			for (size_t i = 0; i < k; ++i)
+			{
+				limb_t carry = AddMul1(t + i, m_n, k, t[i] * m_n_inv);
+				Add1(t + i + k, t + i + k, k + 1 - i, carry);
+			}
+			// t / R < 2n now
+			if (t[2 * k] != 0 || CmpN(t + k, m_n, k) >= 0)
+				SubN(r, t + k, m_n, k);
+			else
+				std::copy(t + k, t + 2 * k, r);
+		}
+
+	private:
+		const limb_t* m_n;
+		size_t m_k;
+		limb_t m_n_inv;
+		Limbs m_t;
+	};
+
+
+	// r = a * b mod n through mu = B^2k / n (HAC 14.42)
+	class BarrettReducer
+	{
+	public:
+		BarrettReducer(const limb_t* n, size_t k, const Limbs& mu) :
+			m_n(n),
+			m_k(k),
+			m_mu(mu),
+			m_t(2 * k),
+			m_q(k + 1 + mu.size()),
+			m_p(2 * k + 1),
+			m_r(k + 1)
+		{}
+
+		size_t Size() const { return m_k; }
+
+		void Mul(limb_t* r, const limb_t* a, const limb_t* b)  // r may be a or b
+		{
+			bigint_impl::Mul(m_t.data(), a, m_k, b, m_k);
+			Reduce(r, m_t.data());
+		}
+
+	private:
+		void Reduce(limb_t* r, const limb_t* x)  // x < n^2, 2k limbs
+		{
+			size_t k = m_k;
+			// q = (x / B^(k-1)) * mu / B^(k+1) underestimates x / n by at most 2
+			bigint_impl::Mul(m_q.data(), x + k - 1, k + 1, m_mu.data(), m_mu.size());
+			const limb_t* q = m_q.data() + k + 1;
+			size_t nq = Normalized(q, m_mu.size());
+
+			// r = (x - q * n) mod B^(k+1), then the final corrections
+			std::fill(m_p.begin(), m_p.end(), 0);
+			if (nq > 0)
+				bigint_impl::Mul(m_p.data(), q, nq, m_n, k);
+			SubN(m_r.data(), x, m_p.data(), k + 1);
+			while (m_r[k] != 0 || CmpN(m_r.data(), m_n, k) >= 0)
+				Sub(m_r.data(), m_r.data(), k + 1, m_n, k);
+			std::copy(m_r.begin(), m_r.begin() + k, r);
+		}
+
+	private:
+		const limb_t* m_n;
+		size_t m_k;
+		const Limbs& m_mu;
+		Limbs m_t, m_q, m_p, m_r;
+	};
+
+
+	bool Bit(const limb_t* e, size_t i)
+	{
+		return ((e[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1) != 0;
+	}
+
+
+	// window width by exponent length, balancing the table against the multiplications saved
+	size_t WindowBits(size_t bits)
+	{
+		if (bits > 671)
+			return 6;
+		if (bits > 239)
+			return 5;
+		if (bits > 79)
+			return 4;
+		if (bits > 23)
+			return 3;
+		return 1;
+	}
+
+
+	// x^e in the domain of the reducer, e > 0 of ne limbs without heading zeroes
+	template<typename Reducer>
+	Limbs PowWindow(Reducer& reducer, const Limbs& x, const limb_t* e, size_t ne)
+	{
+		size_t k = reducer.Size();
+		size_t bits = (ne - 1) * LIMB_BITS + (LIMB_BITS - CountLeadingZeros(e[ne - 1]));
+		size_t w = WindowBits(bits);
+
+		// table[i] = x^(2i + 1)
+		std::vector<Limbs> table(size_t(1) << (w - 1), Limbs(k));
+		table[0] = x;
+		if (w > 1)
+		{
+			Limbs x2(k);
+			reducer.Mul(x2.data(), x.data(), x.data());
+			for (size_t i = 1; i < table.size(); ++i)
+				reducer.Mul(table[i].data(), table[i - 1].data(), x2.data());
+		}
+
+		// the top bit is set, so the first window initializes the result
+		Limbs result;
+		size_t i = bits;  // bits from i up are done
+		while (i > 0)
+		{
+			if (!Bit(e, i - 1))
+			{
+				reducer.Mul(result.data(), result.data(), result.data());
+				--i;
+				continue;
+			}
+			// longest window of at most w bits from bit i - 1 down to a set bit
+			size_t low = (i > w) ? i - w : 0;
+			while (!Bit(e, low))
+				++low;
+			size_t value = 0;
+			for (size_t j = i; j-- > low;)
+				value = (value << 1) | (Bit(e, j) ? 1 : 0);
+			if (result.empty())
+			{
+				result = table[value >> 1];
+			}
+			else
+			{
+				for (size_t j = low; j < i; ++j)
+					reducer.Mul(result.data(), result.data(), result.data());
+				reducer.Mul(result.data(), result.data(), table[value >> 1].data());
+			}
+			i = low;
+		}
+		return result;
+	}
+
+
+	// single-limb modulus: native arithmetic, right-to-left binary powering
+	limb_t PowMod1(limb_t x, const limb_t* e, size_t ne, limb_t n)
+	{
+		dlimb_t result = 1 % n;
+		dlimb_t square = x % n;
+		for (size_t i = 0; i < ne; ++i)
+		{
+			limb_t bits = e[i];
+			for (int j = 0; j < LIMB_BITS && (bits != 0 || i + 1 < ne); ++j, bits >>= 1)
+			{
+				if (bits & 1)
+					result = result * square % n;
+				square = square * square % n;
+			}
+		}
+		return static_cast<limb_t>(result);
+	}
+
+
+	// limbs of 0 <= x < B^k, zero padded to k
+	Limbs ToLimbs(const BigInt& x, size_t k)
+	{
+		Limbs r(k, 0);
+		std::copy(x.GetLimbs().begin(), x.GetLimbs().end(), r.begin());
+		return r;
+	}
+
+
+	// x mod |n| in [0, |n|)
+	BigInt Reduce(const BigInt& x, const BigInt& n)
+	{
+		BigInt r = x % n;
+		if (r.GetSign())
+			r += n.Abs();
+		return r;
+	}
+
+
+	// B^m as a BigInt
+	BigInt LimbPower(size_t m)
+	{
+		return BigInt::Pow(BigInt(2), m * LIMB_BITS);
+	}
+}
+
+}  // namespace bigint_impl
+
+
+using namespace bigint_impl;
+
+
+MontgomeryContext::MontgomeryContext(const BigInt& mod) :
+	m_mod(mod.Abs())
+{
+	if (m_mod.IsZero() || (m_mod.GetLimbs()[0] & 1) == 0 || m_mod == 1)
+		throw std::invalid_argument("MontgomeryContext: the modulus must be odd and greater than 1");
+	size_t k = m_mod.GetNumLimbs();
+	m_n = ToLimbs(m_mod, k);
+	m_r2 = ToLimbs(LimbPower(2 * k) % m_mod, k);
+	m_n_inv = NegInverse(m_n[0]);
+}
+
+
+std::vector<BigInt::limb_t> MontgomeryContext::ToMontgomery(const BigInt& a) const
+{
+	// a * R = Montgomery product of a and R^2
+	size_t k = m_n.size();
+	Limbs x = ToLimbs(Reduce(a, m_mod), k);
+	MontgomeryReducer reducer(m_n.data(), k, m_n_inv);
+	reducer.Mul(x.data(), x.data(), m_r2.data());
+	return x;
+}
+
+
+BigInt MontgomeryContext::FromMontgomery(const std::vector<BigInt::limb_t>& a) const
+{
+	size_t k = m_n.size();
+	Limbs r(k);
+	MontgomeryReducer reducer(m_n.data(), k, m_n_inv);
+	reducer.Reduce(r.data(), a.data());
+	return BigInt::FromLimbs(r.data(), k);
+}
+
+
+BigInt MontgomeryContext::MulMod(const BigInt& a, const BigInt& b) const
+{
+	// (a * R) * b / R = a * b
+	size_t k = m_n.size();
+	Limbs x = ToMontgomery(a);
+	Limbs y = ToLimbs(Reduce(b, m_mod), k);
+	MontgomeryReducer reducer(m_n.data(), k, m_n_inv);
+	reducer.Mul(x.data(), x.data(), y.data());
+	return BigInt::FromLimbs(x.data(), k);
+}
+
+
+BigInt MontgomeryContext::PowMod(const BigInt& base, const BigInt& exp) const
+{
+	if (exp.GetSign())
+		throw std::domain_error("BigInt: negative exponent in PowMod");
+	if (exp.IsZero())
+		return BigInt(1);
+	const BigIntLimbs& e = exp.GetLimbs();
+	size_t k = m_n.size();
+	if (k == 1)
+	{
+		BigInt x = Reduce(base, m_mod);
+		limb_t r = PowMod1(x.IsZero() ? 0 : x.GetLimbs()[0], e.data(), e.size(), m_n[0]);
+		return BigInt::FromLimbs(&r, 1);
+	}
+	MontgomeryReducer reducer(m_n.data(), k, m_n_inv);
+	Limbs result = PowWindow(reducer, ToMontgomery(base), e.data(), e.size());
+	return FromMontgomery(result);
+}
+
+
+BigInt BigInt::PowMod(const BigInt& base, const BigInt& exp, const BigInt& mod)
+{
+	if (mod.IsZero())
+		throw std::domain_error("BigInt: PowMod with zero modulus");
+	if (exp.GetSign())
+		throw std::domain_error("BigInt: negative exponent in PowMod");
+	BigInt n = mod.Abs();
+	if (n == 1)
+		return BigInt();
+	if (n.GetLimbs()[0] & 1)
+		return MontgomeryContext(n).PowMod(base, exp);
+	if (exp.IsZero())
+		return BigInt(1);
+
+	const BigIntLimbs& e = exp.GetLimbs();
+	BigInt x = Reduce(base, n);
+	size_t k = n.GetNumLimbs();
+	if (k == 1)
+	{
+		limb_t r = PowMod1(x.IsZero() ? 0 : x.GetLimbs()[0], e.data(), e.size(), n.GetLimbs()[0]);
+		return FromLimbs(&r, 1);
+	}
+	Limbs nl = ToLimbs(n, k);
+	Limbs mu = ToLimbs(LimbPower(2 * k) / n, k + 2);
+	mu.resize(Normalized(mu.data(), mu.size()));
+	BarrettReducer reducer(nl.data(), k, mu);
+	Limbs result = PowWindow(reducer, ToLimbs(x, k), e.data(), e.size());
+	return FromLimbs(result.data(), k);
+}
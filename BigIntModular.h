@@ -0,0 +1,27 @@
+#pragma once
+
+#include "BigInt.h"
+#include <vector>
+
+// Precomputation of Montgomery multiplication for one odd modulus, so that many
+// modular products and powers with the same modulus skip it. Immutable after
+// construction: one context may be shared by several threads.
+class MontgomeryContext
+{
+public:
+	explicit MontgomeryContext(const BigInt& mod);  // throws std::invalid_argument unless |mod| is odd and > 1
+
+	const BigInt& GetModulus() const { return m_mod; }  // |mod|
+	BigInt MulMod(const BigInt& a, const BigInt& b) const;  // a * b mod |mod|, in [0, |mod|)
+	BigInt PowMod(const BigInt& base, const BigInt& exp) const;  // base^exp mod |mod|, exp >= 0
+
+private:
+	std::vector<BigInt::limb_t> ToMontgomery(const BigInt& a) const;  // a * R mod n, k limbs
+	BigInt FromMontgomery(const std::vector<BigInt::limb_t>& a) const;
+
+private:
+	BigInt m_mod;  // positive
+	std::vector<BigInt::limb_t> m_n;  // limbs of m_mod, k of them
+	std::vector<BigInt::limb_t> m_r2;  // R^2 mod n with R = 2^(32 k)
+	BigInt::limb_t m_n_inv;  // -n^-1 mod 2^32
+};
@@ -0,0 +1,310 @@
+#include "BigIntImpl.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+
+namespace bigint_impl
+{
+
+namespace
+{
+	// signed intermediate value of Toom-3 evaluation and interpolation
+	struct SignedLimbs
+	{
+		std::vector<limb_t> mag;  // no heading zero limbs
+		bool neg = false;
+
+		SignedLimbs() {}
+		SignedLimbs(const limb_t* a, size_t n) : mag(a, a + Normalized(a, n)) {}
+
+		void Normalize()
+		{
+			mag.resize(Normalized(mag.data(), mag.size()));
+			if (mag.empty())
+				neg = false;
+		}
+	};
+
+
+	// |a| + |b| into r
+	void AddAbs(std::vector<limb_t>& r, const std::vector<limb_t>& a, const std::vector<limb_t>& b)
+	{
+		const std::vector<limb_t>& big = (a.size() >= b.size()) ? a : b;
+		const std::vector<limb_t>& small = (a.size() >= b.size()) ? b : a;
+		std::vector<limb_t> sum(big.size() + 1);
+		sum[big.size()] = Add(sum.data(), big.data(), big.size(), small.data(), small.size());
+		r.swap(sum);
+	}
+
+
+	SignedLimbs AddSigned(const SignedLimbs& a, const SignedLimbs& b, bool negate_b)
+	{
+		SignedLimbs r;
+		bool neg_b = (b.neg != negate_b);
+		if (a.neg == neg_b)
+		{
+			AddAbs(r.mag, a.mag, b.mag);
+			r.neg = a.neg;
+		}
+		else
+		{
+			// signs differ: subtract the smaller magnitude from the larger one
+			int cmp = Cmp(a.mag.data(), a.mag.size(), b.mag.data(), b.mag.size());
+			const SignedLimbs& big = (cmp >= 0) ? a : b;
+			const SignedLimbs& small = (cmp >= 0) ? b : a;
+			r.mag.resize(big.mag.size());
+			Sub(r.mag.data(), big.mag.data(), big.mag.size(), small.mag.data(), small.mag.size());
+			r.neg = (cmp >= 0) ? a.neg : neg_b;
+		}
+		r.Normalize();
+		return r;
+	}
+
+
+	SignedLimbs MulSigned(const SignedLimbs& a, const SignedLimbs& b)
+	{
+		SignedLimbs r;
+		if (a.mag.empty() || b.mag.empty())
+			return r;
+		r.mag.resize(a.mag.size() + b.mag.size());
+		Mul(r.mag.data(), a.mag.data(), a.mag.size(), b.mag.data(), b.mag.size());
+		r.neg = (a.neg != b.neg);
+		r.Normalize();
+		return r;
+	}
+
+
+	// x *= m for a small m
+	void MulSmall(SignedLimbs& x, limb_t m)
+	{
+		limb_t high = Mul1(x.mag.data(), x.mag.data(), x.mag.size(), m);
+		if (high != 0)
+			x.mag.push_back(high);
+	}
+
+
+	// x /= d where d is known to divide x: powers of two are shifted out, the odd rest is
+	// a multiplication by its inverse mod 2^32 from the low end (Jebelean), no division
+	void DivExactSmall(SignedLimbs& x, limb_t d)
+	{
+		unsigned shift = 0;
+		while ((d & 1) == 0)
+		{
+			d >>= 1;
+			++shift;
+		}
+		if (shift > 0 && !x.mag.empty())
+			RShift(x.mag.data(), x.mag.data(), x.mag.size(), shift);
+		if (d > 1)
+		{
+			limb_t inv = d;  // d * d == 1 mod 8, every Newton step doubles the correct bits
+			for (int i = 0; i < 4; ++i)
+				inv *= 2 - d * inv;
+			limb_t borrow = 0;
+			for (size_t i = 0; i < x.mag.size(); ++i)
+			{
+				limb_t cur = x.mag[i];
+				limb_t t = cur - borrow;
+				limb_t q = t * inv;
+				x.mag[i] = q;
+				borrow = static_cast<limb_t>((static_cast<dlimb_t>(q) * d) >> LIMB_BITS) + (cur < borrow ? 1 : 0);
+			}
+			assert(borrow == 0);
+		}
+		x.Normalize();
+	}
+
+
+	// r[offset ...] += x, x must be non-negative and fit into r
+	void AddAt(limb_t* r, size_t nr, size_t offset, const SignedLimbs& x)
+	{
+		assert(!x.neg);
+		if (x.mag.empty())
+			return;
+		assert(offset + x.mag.size() <= nr);
+		limb_t carry = Add(r + offset, r + offset, nr - offset, x.mag.data(), x.mag.size());
+		assert(carry == 0);
+		(void)carry;
+	}
+
+
+	// a is split into na / nb chunks, each multiplied by b: keeps every product balanced
+	void MulUnbalanced(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		std::fill(r, r + na + nb, 0);
+		std::vector<limb_t> tmp(2 * nb);
+		for (size_t offset = 0; offset < na; offset += nb)
+		{
+			size_t len = std::min(nb, na - offset);
+			Mul(tmp.data(), a + offset, len, b, nb);
+			limb_t carry = Add(r + offset, r + offset, na + nb - offset, tmp.data(), len + nb);
+			assert(carry == 0);
+			(void)carry;
+		}
+	}
+
+
+	// |a - b| into r (r has max(na, nb) limbs), returns true if a < b
+	bool AbsDiff(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		na = Normalized(a, na);
+		nb = Normalized(b, nb);
+		if (Cmp(a, na, b, nb) >= 0)
+		{
+			std::fill(r + na, r + std::max(na, nb), 0);
+			Sub(r, a, na, b, nb);
+			return false;
+		}
+		std::fill(r + nb, r + std::max(na, nb), 0);
+		Sub(r, b, nb, a, na);
+		return true;
+	}
+
+
+	// Karatsuba: a = a1 * B^h + a0, b = b1 * B^h + b0,
+	// a * b = z2 * B^2h + (z0 + z2 - (a0 - a1)(b0 - b1)) * B^h + z0
+	// requires nb <= na < 2 * nb
+	void MulKaratsuba(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		size_t h = na / 2;
+		size_t na1 = na - h;
+		size_t nb1 = nb - h;
+		const limb_t* a1 = a + h;
+		const limb_t* b1 = b + h;
+
+		// z0 and z2 go straight to their places in r; the three products are independent
+		TaskGroup group(UseThreads(nb));
+		group.Run([=] { Mul(r, a, h, b, h); });
+		group.Run([=] { Mul(r + 2 * h, a1, na1, b1, nb1); });
+
+		size_t nda = na1;  // na1 >= h
+		size_t ndb = std::max(h, nb1);
+		std::vector<limb_t> da(nda);
+		std::vector<limb_t> db(ndb);
+		bool neg = AbsDiff(da.data(), a, h, a1, na1) != AbsDiff(db.data(), b, h, b1, nb1);
+		std::vector<limb_t> z1(nda + ndb);
+		Mul(z1.data(), da.data(), nda, db.data(), ndb);
+		group.Wait();
+
+		// middle = z0 + z2 -/+ z1, always non-negative since it equals a0 * b1 + a1 * b0
+		size_t nz0 = 2 * h;
+		size_t nz2 = na1 + nb1;
+		size_t nmid = std::max(std::max(nz0, nz2), z1.size()) + 1;
+		std::vector<limb_t> mid(nmid, 0);
+		std::copy(r + 2 * h, r + 2 * h + nz2, mid.begin());
+		Add(mid.data(), mid.data(), nmid, r, nz0);
+		if (neg)
+			Add(mid.data(), mid.data(), nmid, z1.data(), z1.size());
+		else
+			Sub(mid.data(), mid.data(), nmid, z1.data(), z1.size());
+
+		size_t len = Normalized(mid.data(), nmid);
+		limb_t carry = Add(r + h, r + h, na + nb - h, mid.data(), len);
+		assert(carry == 0);
+		(void)carry;
+	}
+
+
+	// Toom-3 with Bodrato's evaluation points 0, 1, -1, -2, inf and interpolation sequence
+	// requires nb <= na < 2 * nb
+	void MulToom3(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		size_t k = (na + 2) / 3;
+		SignedLimbs a0(a, k), a1(a + k, k), a2(a + 2 * k, na - 2 * k);
+		assert(nb > k);
+		SignedLimbs b0(b, k), b1(b + k, std::min(k, nb - k)), b2;
+		if (nb > 2 * k)
+			b2 = SignedLimbs(b + 2 * k, nb - 2 * k);
+
+		// evaluation: p(1) = a0 + a1 + a2, p(-1) = a0 - a1 + a2, p(-2) = 2 * (p(-1) + a2) - a0
+		SignedLimbs pa = AddSigned(a0, a2, false);
+		SignedLimbs pa1 = AddSigned(pa, a1, false);
+		SignedLimbs pam1 = AddSigned(pa, a1, true);
+		SignedLimbs pam2 = AddSigned(pam1, a2, false);
+		MulSmall(pam2, 2);
+		pam2 = AddSigned(pam2, a0, true);
+
+		SignedLimbs pb = AddSigned(b0, b2, false);
+		SignedLimbs pb1 = AddSigned(pb, b1, false);
+		SignedLimbs pbm1 = AddSigned(pb, b1, true);
+		SignedLimbs pbm2 = AddSigned(pbm1, b2, false);
+		MulSmall(pbm2, 2);
+		pbm2 = AddSigned(pbm2, b0, true);
+
+		// pointwise products, independent of each other
+		SignedLimbs r0, r1, rm1, rm2, rinf;
+		{
+			TaskGroup group(UseThreads(nb));
+			group.Run([&] { r0 = MulSigned(a0, b0); });
+			group.Run([&] { r1 = MulSigned(pa1, pb1); });
+			group.Run([&] { rm1 = MulSigned(pam1, pbm1); });
+			group.Run([&] { rm2 = MulSigned(pam2, pbm2); });
+			rinf = MulSigned(a2, b2);
+			group.Wait();
+		}
+
+		// interpolation
+		SignedLimbs r3 = AddSigned(rm2, r1, true);
+		DivExactSmall(r3, 3);
+		r1 = AddSigned(r1, rm1, true);
+		DivExactSmall(r1, 2);
+		SignedLimbs r2 = AddSigned(rm1, r0, true);
+		r3 = AddSigned(r2, r3, true);
+		DivExactSmall(r3, 2);
+		SignedLimbs rinf2 = rinf;
+		MulSmall(rinf2, 2);
+		r3 = AddSigned(r3, rinf2, false);
+		r2 = AddSigned(r2, r1, false);
+		r2 = AddSigned(r2, rinf, true);
+		r1 = AddSigned(r1, r3, true);
+
+		// recomposition: every coefficient of the product polynomial is non-negative
+		size_t nr = na + nb;
+		std::fill(r, r + nr, 0);
+		AddAt(r, nr, 0, r0);
+		AddAt(r, nr, k, r1);
+		AddAt(r, nr, 2 * k, r2);
+		AddAt(r, nr, 3 * k, r3);
+		AddAt(r, nr, 4 * k, rinf);
+	}
+}
+
+
+void MulBasecase(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	// schoolbook product: accumulate a * b[j] shifted by j limbs
+	r[na] = Mul1(r, a, na, b[0]);
+	for (size_t j = 1; j < nb; ++j)
+		r[na + j] = AddMul1(r + j, a, na, b[j]);
+}
+
+
+void Mul(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	if (na < nb)
+	{
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
+	if (nb == 0)
+	{
+		std::fill(r, r + na, 0);
+		return;
+	}
+
+	// tiny thresholds would let the splitting recurse forever
+	const BigIntThresholds& th = BigInt::Thresholds();
+	if (nb < std::max<size_t>(th.mul_karatsuba, 2))
+		MulBasecase(r, a, na, b, nb);
+	else if (nb >= th.mul_ntt && NttFits(na, nb))
+		MulNtt(r, a, na, b, nb);
+	else if (na >= 2 * nb)
+		MulUnbalanced(r, a, na, b, nb);
+	else if (nb < std::max<size_t>(th.mul_toom3, 5))
+		MulKaratsuba(r, a, na, b, nb);
+	else
+		MulToom3(r, a, na, b, nb);
+}
+
+}  // namespace bigint_impl
@@ -0,0 +1,376 @@
+#include "BigIntImpl.h"
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+// Exact multiplication by number-theoretic transforms over three 31-bit primes.
+// Each limb (or half limb for huge operands) is one coefficient; the cyclic
+// convolution is computed modulo every prime and the true coefficients, which are
+// below the product of the primes, are recovered by the Chinese remainder theorem.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	// p = c * 2^k + 1 with primitive root g; all three support transforms up to 2^25
+	const uint32_t P1 = 2013265921;  // 15 * 2^27 + 1
+	const uint32_t G1 = 31;
+	const uint32_t P2 = 469762049;  // 7 * 2^26 + 1
+	const uint32_t G2 = 3;
+	const uint32_t P3 = 167772161;  // 5 * 2^25 + 1
+	const uint32_t G3 = 3;
+	const int MAX_LOG_LENGTH = 25;
+
+	// coefficient of a limb product sum stays below P1 * P2 * P3 (~2^87)
+	// while the shorter operand has at most 2^22 full-limb pieces
+	const size_t MAX_FULL_LIMB_PIECES = size_t(1) << 22;
+
+
+	template<uint32_t P>
+	struct ModArith
+	{
+		static uint32_t Mul(uint32_t a, uint32_t b) { return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % P); }
+		static uint32_t Add(uint32_t a, uint32_t b) { uint32_t s = a + b; return (s >= P) ? s - P : s; }
+		static uint32_t Sub(uint32_t a, uint32_t b) { return (a >= b) ? a - b : a + P - b; }
+
+		// a * w for a fixed w with wq = floor(w * 2^32 / P), without a division (Shoup):
+		// the estimated quotient is short by at most one, and P < 2^31 keeps a * w - q * P
+		// in 32 bits
+		static uint32_t ShoupQuotient(uint32_t w) { return static_cast<uint32_t>((static_cast<uint64_t>(w) << 32) / P); }
+		static uint32_t MulShoup(uint32_t a, uint32_t w, uint32_t wq)
+		{
+			uint32_t q = static_cast<uint32_t>((static_cast<uint64_t>(a) * wq) >> 32);
+			uint32_t r = a * w - q * P;
+			return (r >= P) ? r - P : r;
+		}
+
+		static uint32_t Pow(uint32_t a, uint64_t e)
+		{
+			uint32_t r = 1;
+			for (; e > 0; e >>= 1)
+			{
+				if (e & 1)
+					r = Mul(r, a);
+				a = Mul(a, a);
+			}
+			return r;
+		}
+
+		static uint32_t Inv(uint32_t a) { return Pow(a, P - 2); }
+	};
+
+
+	// blocks of this many coefficients are transformed by one thread
+	const size_t PARALLEL_BLOCK = size_t(1) << 14;
+
+
+	// powers of the roots of unity for every stage, with their Shoup quotients
+	struct Roots
+	{
+		std::vector<uint32_t> w;  // w[h + j] = w_{2h}^j
+		std::vector<uint32_t> wq;
+	};
+
+
+	// all butterfly stages of a block of m coefficients in bit-reversed order
+	template<uint32_t P>
+	void Stages(uint32_t* a, size_t m, const Roots& roots)
+	{
+		typedef ModArith<P> M;
+		for (size_t half = 1; half < m; half <<= 1)
+		{
+			const uint32_t* w = roots.w.data() + half;
+			const uint32_t* wq = roots.wq.data() + half;
+			for (size_t i = 0; i < m; i += 2 * half)
+			{
+				for (size_t j = 0; j < half; ++j)
+				{
+					uint32_t u = a[i + j];
+					uint32_t v = M::MulShoup(a[i + j + half], w[j], wq[j]);
+					a[i + j] = M::Add(u, v);
+					a[i + j + half] = M::Sub(u, v);
+				}
+			}
+		}
+	}
+
+
+	// same by fork-join: the two halves of a block are independent transforms,
+	// only the last stage mixes them and it is split over index ranges
+	template<uint32_t P>
+	void StagesParallel(uint32_t* a, size_t m, const Roots& roots)
+	{
+		typedef ModArith<P> M;
+		if (m <= PARALLEL_BLOCK)
+		{
+			Stages<P>(a, m, roots);
+			return;
+		}
+		size_t half = m / 2;
+		{
+			TaskGroup group;
+			group.Run([=, &roots] { StagesParallel<P>(a, half, roots); });
+			StagesParallel<P>(a + half, half, roots);
+			group.Wait();
+		}
+		const uint32_t* w = roots.w.data() + half;
+		const uint32_t* wq = roots.wq.data() + half;
+		ParallelFor(0, half, PARALLEL_BLOCK, [=](size_t lo, size_t hi)
+		{
+			for (size_t j = lo; j < hi; ++j)
+			{
+				uint32_t u = a[j];
+				uint32_t v = M::MulShoup(a[j + half], w[j], wq[j]);
+				a[j] = M::Add(u, v);
+				a[j + half] = M::Sub(u, v);
+			}
+		});
+	}
+
+
+	// in-place forward transform of length n (a power of two)
+	template<uint32_t P>
+	void Transform(uint32_t* a, size_t n, const Roots& roots, bool parallel)
+	{
+		if (!parallel)
+		{
+			for (size_t i = 1, j = 0; i < n; ++i)
+			{
+				size_t bit = n >> 1;
+				for (; j & bit; bit >>= 1)
+					j ^= bit;
+				j |= bit;
+				if (i < j)
+					std::swap(a[i], a[j]);
+			}
+			Stages<P>(a, n, roots);
+			return;
+		}
+
+		// every i swaps with its bit reversal once, from the smaller index of the pair;
+		// a range reverses its first index bit by bit and then counts in reversed order
+		int log_n = 0;
+		while ((size_t(1) << log_n) < n)
+			++log_n;
+		ParallelFor(0, n, PARALLEL_BLOCK, [=](size_t lo, size_t hi)
+		{
+			size_t j = 0;
+			for (int bit = 0; bit < log_n; ++bit)
+				j |= ((lo >> bit) & 1) << (log_n - 1 - bit);
+			for (size_t i = lo; i < hi; ++i)
+			{
+				if (i < j)
+					std::swap(a[i], a[j]);
+				size_t bit = n >> 1;
+				for (; j & bit; bit >>= 1)
+					j ^= bit;
+				j |= bit;
+			}
+		});
+		StagesParallel<P>(a, n, roots);
+	}
+
+
+	template<uint32_t P, uint32_t G>
+	Roots MakeRoots(size_t n)
+	{
+		typedef ModArith<P> M;
+		Roots roots;
+		roots.w.resize(std::max<size_t>(n, 2));
+		roots.wq.resize(roots.w.size());
+		for (size_t half = 1; half < n; half <<= 1)
+		{
+			uint32_t base = M::Pow(G, (P - 1) / (2 * half));
+			uint32_t base_q = M::ShoupQuotient(base);
+			uint32_t w = 1;
+			for (size_t j = 0; j < half; ++j)
+			{
+				roots.w[half + j] = w;
+				roots.wq[half + j] = M::ShoupQuotient(w);
+				w = M::MulShoup(w, base, base_q);
+			}
+		}
+		return roots;
+	}
+
+
+	// the table for transforms of length n, built once per prime and length and never
+	// changed afterwards, so it can be read without the lock
+	template<uint32_t P, uint32_t G>
+	const Roots& CachedRoots(size_t n)
+	{
+		static std::mutex mutex;
+		static std::unique_ptr<Roots> tables[MAX_LOG_LENGTH + 1];
+
+		int log_n = 0;
+		while ((size_t(1) << log_n) < n)
+			++log_n;
+		std::lock_guard<std::mutex> lock(mutex);
+		std::unique_ptr<Roots>& table = tables[log_n];
+		if (!table)
+			table.reset(new Roots(MakeRoots<P, G>(n)));
+		return *table;
+	}
+
+
+	// split the limbs into n coefficients of piece_bits each
+	template<uint32_t P>
+	void LoadPieces(uint32_t* dst, size_t n, const limb_t* a, size_t na, int piece_bits)
+	{
+		size_t count = 0;
+		if (piece_bits == LIMB_BITS)
+		{
+			for (; count < na; ++count)
+				dst[count] = a[count] % P;
+		}
+		else
+		{
+			for (size_t i = 0; i < na; ++i)
+			{
+				dst[count++] = a[i] & 0xFFFF;
+				dst[count++] = a[i] >> 16;
+			}
+		}
+		std::fill(dst + count, dst + n, 0);
+	}
+
+
+	// residues of the cyclic convolution of a and b modulo P, in place of fa
+	template<uint32_t P, uint32_t G>
+	void ConvolveMod(std::vector<uint32_t>& fa, const limb_t* a, size_t na, const limb_t* b, size_t nb,
+		size_t n, int piece_bits, bool parallel)
+	{
+		typedef ModArith<P> M;
+		const Roots& roots = CachedRoots<P, G>(n);
+		fa.resize(n);
+		LoadPieces<P>(fa.data(), n, a, na, piece_bits);
+		uint32_t* x = fa.data();
+		std::vector<uint32_t> fb;
+		if (a == b && na == nb)
+		{
+			Transform<P>(x, n, roots, parallel);
+			ParallelFor(0, n, parallel ? PARALLEL_BLOCK : n, [=](size_t lo, size_t hi)
+			{
+				for (size_t i = lo; i < hi; ++i)
+					x[i] = M::Mul(x[i], x[i]);
+			});
+		}
+		else
+		{
+			fb.resize(n);
+			LoadPieces<P>(fb.data(), n, b, nb, piece_bits);
+			uint32_t* y = fb.data();
+			TaskGroup group(parallel);
+			group.Run([&] { Transform<P>(y, n, roots, parallel); });
+			Transform<P>(x, n, roots, parallel);
+			group.Wait();
+			ParallelFor(0, n, parallel ? PARALLEL_BLOCK : n, [=](size_t lo, size_t hi)
+			{
+				for (size_t i = lo; i < hi; ++i)
+					x[i] = M::Mul(x[i], y[i]);
+			});
+		}
+		// inverse transform: forward transform, reverse fa[1 .. n), scale by 1 / n
+		Transform<P>(x, n, roots, parallel);
+		std::reverse(fa.begin() + 1, fa.end());
+		uint32_t inv_n = M::Inv(static_cast<uint32_t>(n % P));
+		ParallelFor(0, n, parallel ? PARALLEL_BLOCK : n, [=](size_t lo, size_t hi)
+		{
+			for (size_t i = lo; i < hi; ++i)
+				x[i] = M::Mul(x[i], inv_n);
+		});
+	}
+
+
+	int PieceBits(size_t na, size_t nb)
+	{
+		return (std::min(na, nb) <= MAX_FULL_LIMB_PIECES) ? LIMB_BITS : 16;
+	}
+
+
+	size_t TransformLength(size_t na, size_t nb, int piece_bits)
+	{
+		size_t pieces = (na + nb) * (LIMB_BITS / piece_bits);
+		size_t n = 1;
+		while (n < pieces)
+			n <<= 1;
+		return n;
+	}
+}
+
+
+bool NttFits(size_t na, size_t nb)
+{
+	return TransformLength(na, nb, PieceBits(na, nb)) <= (size_t(1) << MAX_LOG_LENGTH);
+}
+
+
+void MulNtt(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+{
+	assert(NttFits(na, nb));
+	int piece_bits = PieceBits(na, nb);
+	size_t n = TransformLength(na, nb, piece_bits);
+
+	// the three residue convolutions are independent
+	std::vector<uint32_t> c1, c2, c3;
+	bool parallel = UseThreads(std::min(na, nb));
+	{
+		TaskGroup group(parallel);
+		group.Run([&] { ConvolveMod<P1, G1>(c1, a, na, b, nb, n, piece_bits, parallel); });
+		group.Run([&] { ConvolveMod<P2, G2>(c2, a, na, b, nb, n, piece_bits, parallel); });
+		ConvolveMod<P3, G3>(c3, a, na, b, nb, n, piece_bits, parallel);
+		group.Wait();
+	}
+
+	// Garner's algorithm: x = v1 + v2 * P1 + v3 * P1 * P2
+	const uint32_t inv_p1_mod_p2 = ModArith<P2>::Inv(P1 % P2);
+	const uint32_t inv_p1p2_mod_p3 = ModArith<P3>::Inv(ModArith<P3>::Mul(P1 % P3, P2 % P3));
+	const uint64_t p1p2 = static_cast<uint64_t>(P1) * P2;
+	const uint32_t p1p2_lo = static_cast<uint32_t>(p1p2);
+	const uint32_t p1p2_hi = static_cast<uint32_t>(p1p2 >> 32);
+	const uint32_t piece_mask = (piece_bits == LIMB_BITS) ? 0xFFFFFFFF : 0xFFFF;
+
+	// running sum of the coefficients, 128 bits wide
+	uint64_t acc_lo = 0;
+	uint64_t acc_hi = 0;
+	size_t nr = na + nb;
+	std::fill(r, r + nr, 0);
+	size_t pieces = nr * (LIMB_BITS / piece_bits);
+	for (size_t i = 0; i < pieces; ++i)
+	{
+		if (i < n)
+		{
+			uint32_t v1 = c1[i];
+			uint32_t v2 = ModArith<P2>::Mul(ModArith<P2>::Sub(c2[i], v1 % P2), inv_p1_mod_p2);
+			// (c3 - v1 - v2 * P1) / (P1 * P2) mod P3
+			uint32_t t = ModArith<P3>::Add(v1 % P3, ModArith<P3>::Mul(v2 % P3, P1 % P3));
+			uint32_t v3 = ModArith<P3>::Mul(ModArith<P3>::Sub(c3[i], t), inv_p1p2_mod_p3);
+
+			// acc += v1 + v2 * P1 + v3 * P1 * P2
+			uint64_t low = static_cast<uint64_t>(v1) + static_cast<uint64_t>(v2) * P1;
+			uint64_t m_lo = static_cast<uint64_t>(v3) * p1p2_lo;
+			uint64_t m_hi = static_cast<uint64_t>(v3) * p1p2_hi;
+			uint64_t add_lo = m_lo + (m_hi << 32);
+			uint64_t add_hi = (m_hi >> 32) + ((add_lo < m_lo) ? 1 : 0);
+			add_lo += low;
+			add_hi += (add_lo < low) ? 1 : 0;
+			acc_lo += add_lo;
+			acc_hi += add_hi + ((acc_lo < add_lo) ? 1 : 0);
+		}
+
+		uint32_t piece = static_cast<uint32_t>(acc_lo) & piece_mask;
+		if (piece_bits == LIMB_BITS)
+			r[i] = piece;
+		else
+			r[i / 2] |= piece << (16 * (i % 2));
+		acc_lo = (acc_lo >> piece_bits) | (acc_hi << (64 - piece_bits));
+		acc_hi >>= piece_bits;
+	}
+	assert(acc_lo == 0 && acc_hi == 0);
+}
+
+}  // namespace bigint_impl
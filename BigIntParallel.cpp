@@ -0,0 +1,274 @@
+#include "BigIntImpl.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+
+
+// Work-stealing thread pool: every worker owns a deque, pushes and pops its own tasks
+// at the back (depth first, cache friendly) and steals from the front of the others
+// (the oldest, largest pieces of a recursion) when it runs dry. Threads that are not
+// workers queue their tasks in a shared injection deque.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	struct Task
+	{
+		std::function<void()> body;
+		TaskGroup* group;
+	};
+
+
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+
+	thread_local size_t worker_index = SIZE_MAX;  // SIZE_MAX on threads outside the pool
+}
+
+
+class ThreadPool
+{
+public:
+	explicit ThreadPool(size_t threads) :
+		m_queues(threads),  // threads - 1 workers and the injection queue
+		m_queued(0),
+		m_stop(false)
+	{
+		for (size_t i = 0; i < threads; ++i)
+			m_queues[i].reset(new TaskQueue);
+		for (size_t i = 0; i + 1 < threads; ++i)
+			m_workers.emplace_back([this, i] { WorkerLoop(i); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	size_t NumThreads() const { return m_queues.size(); }
+
+	void Push(Task task)
+	{
+		size_t self = (worker_index < m_workers.size()) ? worker_index : m_workers.size();
+		{
+			std::lock_guard<std::mutex> lock(m_queues[self]->mutex);
+			m_queues[self]->tasks.push_back(std::move(task));
+		}
+		m_queued.fetch_add(1);
+		// taking the lock orders the push before a worker's check of m_queued
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		}
+		m_wake.notify_one();
+	}
+
+	// runs one queued task if there is any: own queue first, then injected, then stolen work
+	bool RunOne()
+	{
+		Task task;
+		if (!TakeTask(task))
+			return false;
+		std::exception_ptr error;
+		try
+		{
+			task.body();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		task.group->Finish(error);
+		return true;
+	}
+
+	// blocks until there is queued work or done() holds; Wake() rechecks done()
+	template<typename F>
+	void Sleep(F done)
+	{
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_wake.wait(lock, [&] { return m_queued.load() > 0 || done(); });
+	}
+
+	void Wake()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		}
+		m_wake.notify_all();
+	}
+
+private:
+	bool TakeTask(Task& task)
+	{
+		if (m_queued.load() == 0)
+			return false;
+		size_t n = m_queues.size();
+		size_t self = (worker_index < m_workers.size()) ? worker_index : m_workers.size();
+		for (size_t k = 0; k < n; ++k)
+		{
+			size_t victim = (self + k) % n;
+			TaskQueue& queue = *m_queues[victim];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty())
+				continue;
+			if (victim == self && self < m_workers.size())
+			{
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+			}
+			m_queued.fetch_sub(1);
+			return true;
+		}
+		return false;
+	}
+
+	void WorkerLoop(size_t index)
+	{
+		worker_index = index;
+		for (;;)
+		{
+			if (RunOne())
+				continue;
+			std::unique_lock<std::mutex> lock(m_sleep_mutex);
+			m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+			if (m_stop)
+				return;
+		}
+	}
+
+private:
+	std::vector<std::unique_ptr<TaskQueue>> m_queues;
+	std::vector<std::thread> m_workers;
+	std::atomic<size_t> m_queued;  // tasks in all queues
+	std::mutex m_sleep_mutex;
+	std::condition_variable m_wake;
+	bool m_stop;
+};
+
+
+namespace
+{
+	std::unique_ptr<ThreadPool> pool;  // null while single-threaded
+}
+
+
+size_t NumThreads()
+{
+	return pool ? pool->NumThreads() : 1;
+}
+
+
+void SetNumThreads(size_t n)
+{
+	if (n == 0)
+		n = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+	pool.reset();
+	if (n > 1)
+		pool.reset(new ThreadPool(n));
+}
+
+
+bool UseThreads(size_t nb)
+{
+	return pool && nb >= BigInt::Thresholds().mul_parallel;
+}
+
+
+TaskGroup::~TaskGroup()
+{
+	try
+	{
+		Wait();
+	}
+	catch (...)
+	{
+	}
+}
+
+
+void TaskGroup::Run(std::function<void()> task)
+{
+	if (!pool || !m_parallel)
+	{
+		task();
+		return;
+	}
+	m_pending.fetch_add(1);
+	pool->Push(Task{ std::move(task), this });
+}
+
+
+void TaskGroup::Wait()
+{
+	while (m_pending.load() > 0)
+	{
+		// help with queued work; with none left, sleep until there is more or the stolen tasks finish
+		if (!pool->RunOne())
+			pool->Sleep([this] { return m_pending.load() == 0; });
+	}
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::swap(error, m_error);
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
+
+void TaskGroup::Finish(std::exception_ptr error)
+{
+	if (error)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_error)
+			m_error = error;
+	}
+	if (m_pending.fetch_sub(1) == 1)
+		pool->Wake();  // the group may be gone now, only the pool is left to touch
+}
+
+
+void ParallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+	size_t n = end - begin;
+	grain = std::max<size_t>(grain, 1);
+	// a few pieces per thread balance uneven progress
+	size_t pieces = std::min(n / grain, 4 * NumThreads());
+	if (pieces <= 1)
+	{
+		body(begin, end);
+		return;
+	}
+	TaskGroup group;
+	for (size_t i = 1; i < pieces; ++i)
+	{
+		size_t lo = begin + n * i / pieces;
+		size_t hi = begin + n * (i + 1) / pieces;
+		group.Run([&body, lo, hi] { body(lo, hi); });
+	}
+	body(begin, begin + n / pieces);
+	group.Wait();
+}
+
+}  // namespace bigint_impl
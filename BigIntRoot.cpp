@@ -0,0 +1,350 @@
+#include "BigIntImpl.h"
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+
+// Integer roots by Newton's iteration y' = ((k - 1) y + x / y^(k - 1)) / k with doubling
+// precision: the root of the leading half of x, shifted into place, is accurate to half
+// of the bits, so a single step at full precision makes it exact but for a few units.
+// Perfect squares and powers are screened by residues before any root is taken.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	// roots of at most this many bits start from a floating-point estimate
+	const size_t ROOT_ESTIMATE_BITS = 48;
+
+
+	// one Newton step: not below the root for any y > 0, smaller than y while y is above it
+	BigInt NewtonStep(const BigInt& x, const BigInt& y, unsigned k)
+	{
+		if (k == 2)
+			return (y + x / y) / 2;
+		return (y * static_cast<int>(k - 1) + x / BigInt::Pow(y, k - 1)) / static_cast<int>(k);
+	}
+
+
+	bool Exceeds(const BigInt& y, unsigned k, const BigInt& x)  // y^k > x for x > 0
+	{
+		if (y.IsZero())
+			return false;
+		// 2^((b - 1) k) <= y^k < 2^(b k) for y of b bits settles most cases without the power
+		size_t y_bits = y.BitLength();
+		size_t x_bits = x.BitLength();
+		if ((y_bits - 1) * k >= x_bits)
+			return true;
+		if (y_bits * k < x_bits)
+			return false;
+		return ((k == 2) ? y * y : BigInt::Pow(y, k)) > x;
+	}
+
+
+	// floor(x^(1/k)) for x > 0
+	BigInt RootFloor(const BigInt& x, unsigned k)
+	{
+		size_t bits = x.BitLength();
+		if (k >= bits)  // x < 2^k
+			return 1;
+		size_t root_bits = (bits + k - 1) / k;
+		if (root_bits <= ROOT_ESTIMATE_BITS)
+		{
+			// log2 of x from its leading limbs
+			const BigIntLimbs& limbs = x.GetLimbs();
+			size_t n = limbs.size();
+			double top = 0;
+			for (size_t i = n; i-- > 0 && i + 3 >= n;)
+				top = top * 4294967296.0 + limbs[i];
+			double log2x = std::log2(top) + double(LIMB_BITS) * double((n > 3) ? n - 3 : 0);
+			uint64_t estimate = static_cast<uint64_t>(std::exp2(log2x / k));
+			limb_t e[2] = { static_cast<limb_t>(estimate), static_cast<limb_t>(estimate >> LIMB_BITS) };
+			BigInt y = BigInt::FromLimbs(e, 2);
+			// the estimate is off by a few units at most
+			while (y > 1 && Exceeds(y, k, x))
+				--y;
+			while (!Exceeds(y + 1, k, x))
+				++y;
+			return y;
+		}
+
+		// the root of x / 2^(k s) is accurate to about root_bits - s bits; the error of a
+		// Newton step is about the square of the previous one over the root
+		size_t margin = 4;
+		for (unsigned t = k; t > 1; t >>= 1)
+			++margin;
+		size_t s = (root_bits - margin) / 2;
+		BigInt y = RootFloor(x >> (k * s), k) << s;
+		if (y.IsZero())
+			y = 1;
+		y = NewtonStep(x, y, k);
+		while (Exceeds(y, k, x))
+			y = NewtonStep(x, y, k);
+		return y;
+	}
+
+
+	// squares mod 64 and mod the factors 3, 5, 17, 257 and 65537 of 2^32 - 1: a non-square
+	// passes with a probability of about 1%, and no division is needed
+	bool MayBeSquare(const BigInt& x)
+	{
+		const BigIntLimbs& limbs = x.GetLimbs();
+		static const uint64_t squares_mod64 = []
+		{
+			uint64_t mask = 0;
+			for (unsigned i = 0; i < 64; ++i)
+				mask |= uint64_t(1) << (i * i % 64);
+			return mask;
+		}();
+		if (((squares_mod64 >> (limbs[0] % 64)) & 1) == 0)
+			return false;
+
+		// 2^32 == 1 mod 2^32 - 1, so x is congruent to the sum of its limbs
+		uint64_t sum = 0;
+		for (size_t i = 0; i < limbs.size(); ++i)
+			sum += limbs[i];
+		uint64_t r = sum % 0xffffffffu;
+
+		const unsigned small_primes[] = { 3, 5, 17, 257 };
+		for (unsigned p : small_primes)
+		{
+			unsigned a = static_cast<unsigned>(r % p);
+			bool square = false;
+			for (unsigned i = 0; i <= p / 2 && !square; ++i)
+				square = (i * i % p == a);
+			if (!square)
+				return false;
+		}
+		// Euler's criterion for the prime 65537
+		uint64_t a = r % 65537;
+		for (int i = 0; i < 15; ++i)  // a^(2^15) == a^((65537 - 1) / 2)
+			a = a * a % 65537;
+		return a <= 1;
+	}
+
+
+	bool IsPrime(uint64_t n)
+	{
+		if (n < 2)
+			return false;
+		for (uint64_t d = 2; d * d <= n; ++d)
+			if (n % d == 0)
+				return false;
+		return true;
+	}
+
+
+	uint64_t PowModU64(uint64_t base, uint64_t exp, uint64_t mod)  // mod < 2^32
+	{
+		uint64_t result = 1;
+		base %= mod;
+		for (; exp > 0; exp >>= 1)
+		{
+			if (exp & 1)
+				result = result * base % mod;
+			base = base * base % mod;
+		}
+		return result;
+	}
+
+
+	// the odd primes below 256, each with its highest power that fits a limb: x mod that power
+	// gives x mod the prime, and the exponent of the prime in x unless the residue is zero
+	struct SmallPrime
+	{
+		limb_t prime;
+		limb_t power;
+	};
+
+	const std::vector<SmallPrime>& SmallPrimes()
+	{
+		static const std::vector<SmallPrime> primes = []
+		{
+			std::vector<SmallPrime> result;
+			for (limb_t f = 3; f < 256; f += 2)
+			{
+				if (!IsPrime(f))
+					continue;
+				limb_t power = f;
+				while (power <= 0xffffffffu / f)
+					power *= f;
+				result.push_back({ f, power });
+			}
+			return result;
+		}();
+		return primes;
+	}
+
+
+	// false when x is certainly no p-th power: checks x^((q - 1) / p) == 1 mod two primes
+	// q == 1 mod p, in which only one residue in p is a p-th power, in one pass when it can
+	bool MayBePower(const BigInt& x, unsigned p)
+	{
+		uint64_t q[2];
+		int found = 0;
+		for (uint64_t c = 2 * uint64_t(p) + 1; found < 2 && c < 0xffffffffu; c += 2 * uint64_t(p))
+			if (IsPrime(c))
+				q[found++] = c;
+		const BigIntLimbs& limbs = x.GetLimbs();
+		bool together = (found == 2 && q[0] * q[1] <= 0xffffffffu);
+		uint64_t both = together ? Mod1(limbs.data(), limbs.size(), static_cast<limb_t>(q[0] * q[1])) : 0;
+		for (int i = 0; i < found; ++i)
+		{
+			uint64_t r = together ? both % q[i] : Mod1(limbs.data(), limbs.size(), static_cast<limb_t>(q[i]));
+			if (r != 0 && PowModU64(r, (q[i] - 1) / p, q[i]) != 1)
+				return false;
+		}
+		return true;
+	}
+
+
+	// x^(1/p) mod 2^64 for odd x and odd p: the odd residues form a group of exponent 2^62, in
+	// which raising to the inverse of p mod 2^64 undoes raising to p
+	uint64_t OddRoot2Adic(uint64_t x, uint64_t p)
+	{
+		uint64_t inverse = p;  // right in 3 bits, and each Newton step doubles them
+		for (int i = 0; i < 5; ++i)
+			inverse *= 2 - p * inverse;
+		uint64_t root = 1;
+		for (; inverse > 0; inverse >>= 1)
+		{
+			if (inverse & 1)
+				root *= x;
+			x *= x;
+		}
+		return root;
+	}
+
+
+	// whether odd > 0 is a p-th power for the prime p, given its residues mod SmallPrimes()
+	bool IsOddPower(const BigInt& odd, unsigned p, const std::vector<limb_t>& residues)
+	{
+		if (odd == 1)
+			return true;
+		const std::vector<SmallPrime>& primes = SmallPrimes();
+		// mod a prime q == 1 mod p only one residue in p is a p-th power
+		int screened = 0;
+		for (size_t i = 0; i < primes.size(); ++i)
+		{
+			limb_t q = primes[i].prime;
+			if ((q - 1) % p != 0)
+				continue;
+			++screened;
+			limb_t r = residues[i] % q;
+			if (r != 0 && PowModU64(r, (q - 1) / p, q) != 1)
+				return false;
+		}
+		if (p == 2)
+			return BigInt::IsPerfectSquare(odd);
+
+		size_t root_bits = (odd.BitLength() + p - 1) / p;
+		if (root_bits <= 64)
+		{
+			// a root is odd and below 2^root_bits, so it is the root mod 2^64 cut to that
+			const BigIntLimbs& limbs = odd.GetLimbs();
+			uint64_t low = (limbs.size() > 1) ? (uint64_t(limbs[1]) << LIMB_BITS) | limbs[0] : limbs[0];
+			uint64_t y = OddRoot2Adic(low, p);
+			if (root_bits < 64)
+				y &= (uint64_t(1) << root_bits) - 1;
+			for (size_t i = 0; i < primes.size(); ++i)
+				if (PowModU64(y, p, primes[i].prime) != residues[i] % primes[i].prime)
+					return false;
+			return BigInt::Pow(y, p) == odd;
+		}
+		if (screened < 2 && !MayBePower(odd, p))
+			return false;
+		return BigInt::Pow(RootFloor(odd, p), p) == odd;
+	}
+}
+
+}  // namespace bigint_impl
+
+
+using namespace bigint_impl;
+
+
+BigInt BigInt::ISqrt(const BigInt& x)
+{
+	return IRoot(x, 2);
+}
+
+
+BigInt BigInt::IRoot(const BigInt& x, unsigned k)
+{
+	if (k == 0)
+		throw std::invalid_argument("BigInt: zeroth root");
+	if (x.GetSign() && k % 2 == 0)
+		throw std::domain_error("BigInt: even root of a negative value");
+	if (x.IsZero() || k == 1)
+		return x;
+	BigInt root = RootFloor(x.Abs(), k);
+	if (x.GetSign())
+		root.Negate();
+	return root;
+}
+
+
+bool BigInt::IsPerfectSquare(const BigInt& x)
+{
+	if (x.GetSign())
+		return false;
+	if (x.IsZero())
+		return true;
+	if (!MayBeSquare(x))
+		return false;
+	BigInt root = RootFloor(x, 2);
+	return root * root == x;
+}
+
+
+bool BigInt::IsPerfectPower(const BigInt& x)
+{
+	BigInt n = x.Abs();
+	if (n <= 1)
+		return true;
+	// y^p for p prime is enough: y^(p m) == (y^m)^p. With n == 2^twos odd, odd is a p-th
+	// power then, and p divides twos and the exponent of every other prime in n.
+	size_t twos = n.TrailingZeros();
+	BigInt odd = n >> twos;
+	const BigIntLimbs& limbs = odd.GetLimbs();
+	const std::vector<SmallPrime>& primes = SmallPrimes();
+	std::vector<limb_t> residues(primes.size());
+	size_t exponents = twos;  // gcd of the known exponents, 0 for none
+	bool small_factor = false;
+	for (size_t i = 0; i < primes.size(); ++i)
+	{
+		limb_t r = Mod1(limbs.data(), limbs.size(), primes[i].power);
+		residues[i] = r;
+		if (r % primes[i].prime != 0)
+			continue;
+		small_factor = true;
+		if (r == 0)
+			continue;
+		size_t e = 0;
+		for (; r % primes[i].prime == 0; r /= primes[i].prime)
+			++e;
+		exponents = std::gcd(exponents, e);
+	}
+
+	// an odd root y > 1 is at least 3, and above 256 without a small factor: odd >= y^p
+	// bounds p by the bits of odd over those of y less one
+	size_t bits = odd.BitLength();
+	size_t limit = (bits > 1) ? (bits - 1) / (small_factor ? 1 : 8) : 0;
+	if (exponents != 0 && (bits == 1 || exponents < limit))
+		limit = exponents;
+	std::vector<bool> composite(limit + 1, false);
+	for (size_t p = 2; p <= limit; ++p)
+	{
+		if (composite[p])
+			continue;
+		for (size_t m = p * p; m <= limit; m += p)
+			composite[m] = true;
+		// only odd powers are negative
+		if ((exponents != 0 && exponents % p != 0) || (x.GetSign() && p == 2))
+			continue;
+		if (IsOddPower(odd, static_cast<unsigned>(p), residues))
+			return true;
+	}
+	return false;
+}
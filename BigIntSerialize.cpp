@@ -0,0 +1,227 @@
+#include "BigIntImpl.h"
+#include "BigIntView.h"
+#include <stdexcept>
+
+
+// Binary form: a LEB128 varint of 2 * limbs + sign, then the limbs least significant
+// first, 4 little-endian bytes each. Only the canonical form is accepted: the shortest
+// varint, no heading zero limb and no negative zero, so equal values have equal bytes.
+
+namespace bigint_impl
+{
+
+namespace
+{
+	const size_t LIMB_BYTES = sizeof(limb_t);
+
+
+	// assembled byte by byte so that any alignment and host byte order work; compilers
+	// turn it into a single load on little-endian targets
+	limb_t LoadLimb(const uint8_t* p)
+	{
+		return static_cast<limb_t>(p[0]) | (static_cast<limb_t>(p[1]) << 8) |
+			(static_cast<limb_t>(p[2]) << 16) | (static_cast<limb_t>(p[3]) << 24);
+	}
+
+
+	void StoreLimb(uint8_t* p, limb_t x)
+	{
+		p[0] = static_cast<uint8_t>(x);
+		p[1] = static_cast<uint8_t>(x >> 8);
+		p[2] = static_cast<uint8_t>(x >> 16);
+		p[3] = static_cast<uint8_t>(x >> 24);
+	}
+
+
+	size_t VarintSize(uint64_t x)
+	{
+		size_t n = 1;
+		for (; x >= 0x80; x >>= 7)
+			++n;
+		return n;
+	}
+
+
+	struct Header
+	{
+		size_t header_size;
+		size_t num_limbs;
+		bool negative;
+	};
+
+
+	Header ReadHeader(const uint8_t* data, size_t size)
+	{
+		uint64_t value = 0;
+		size_t i = 0;
+		for (unsigned shift = 0;; shift += 7)
+		{
+			if (i == size)
+				throw std::invalid_argument("BigInt: truncated serialized header");
+			uint8_t byte = data[i++];
+			if (shift == 63 ? byte > 1 : shift > 63)
+				throw std::invalid_argument("BigInt: serialized length out of range");
+			if (byte == 0 && shift > 0)
+				throw std::invalid_argument("BigInt: non-canonical serialized header");
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				break;
+		}
+		Header h = { i, static_cast<size_t>(value >> 1), (value & 1) != 0 };
+		if (h.num_limbs != value >> 1 || h.num_limbs > (size - i) / LIMB_BYTES)
+			throw std::invalid_argument("BigInt: truncated serialized limbs");
+		if (h.num_limbs == 0 ? h.negative : LoadLimb(data + i + (h.num_limbs - 1) * LIMB_BYTES) == 0)
+			throw std::invalid_argument("BigInt: non-canonical serialized limbs");
+		return h;
+	}
+}
+
+}  // namespace bigint_impl
+
+
+using namespace bigint_impl;
+
+
+size_t BigInt::GetSerializedSize() const
+{
+	return VarintSize(static_cast<uint64_t>(m_limbs.size()) * 2) + m_limbs.size() * LIMB_BYTES;
+}
+
+
+size_t BigInt::Serialize(uint8_t* out) const
+{
+	uint8_t* p = out;
+	for (uint64_t header = static_cast<uint64_t>(m_limbs.size()) * 2 + (m_sign ? 1 : 0); ; header >>= 7)
+	{
+		if (header < 0x80)
+		{
+			*p++ = static_cast<uint8_t>(header);
+			break;
+		}
+		*p++ = static_cast<uint8_t>(header | 0x80);
+	}
+	for (limb_t limb : m_limbs)
+	{
+		StoreLimb(p, limb);
+		p += LIMB_BYTES;
+	}
+	return p - out;
+}
+
+
+std::vector<uint8_t> BigInt::Serialize() const
+{
+	std::vector<uint8_t> out(GetSerializedSize());
+	Serialize(out.data());
+	return out;
+}
+
+
+BigInt BigInt::Deserialize(const uint8_t* data, size_t size, size_t* used)
+{
+	Header h = ReadHeader(data, size);
+	BigInt x;
+	x.m_limbs.resize(h.num_limbs);
+	const uint8_t* p = data + h.header_size;
+	for (size_t i = 0; i < h.num_limbs; ++i, p += LIMB_BYTES)
+		x.m_limbs[i] = LoadLimb(p);
+	x.m_sign = h.negative;
+	if (used)
+		*used = p - data;
+	return x;
+}
+
+
+BigIntView::BigIntView(const uint8_t* data, size_t size)
+{
+	Header h = ReadHeader(data, size);
+	m_data = data;
+	m_limbs = data + h.header_size;
+	m_num_limbs = h.num_limbs;
+	m_size = h.header_size + h.num_limbs * LIMB_BYTES;
+	m_sign = h.negative;
+}
+
+
+BigInt::limb_t BigIntView::GetLimb(size_t i) const
+{
+	return LoadLimb(m_limbs + i * LIMB_BYTES);
+}
+
+
+size_t BigIntView::BitLength() const
+{
+	if (IsZero())
+		return 0;
+	return m_num_limbs * LIMB_BITS - CountLeadingZeros(GetLimb(m_num_limbs - 1));
+}
+
+
+bool BigIntView::TestBit(size_t i) const
+{
+	size_t k = i / LIMB_BITS;
+	if (k >= m_num_limbs)
+		return m_sign;
+	limb_t limb = GetLimb(k);
+	if (m_sign)
+	{
+		// ~(|x| - 1): the borrow reaches limb k only when all limbs below it are zero
+		size_t low = 0;
+		while (GetLimb(low) == 0)
+			++low;
+		if (k < low)
+			return false;
+		limb = (k == low) ? ~(limb - 1) : ~limb;
+	}
+	return ((limb >> (i % LIMB_BITS)) & 1) != 0;
+}
+
+
+BigInt BigIntView::ToBigInt() const
+{
+	if (!m_data)
+		return BigInt();
+	return BigInt::Deserialize(m_data, m_size);
+}
+
+
+std::string BigIntView::GetViewStr() const
+{
+	return ToBigInt().GetViewStr();
+}
+
+
+int BigIntView::Compare(const BigIntView& a, const BigIntView& b)
+{
+	if (a.m_sign != b.m_sign)
+		return a.m_sign ? -1 : 1;
+	int cmp = 0;
+	if (a.m_num_limbs != b.m_num_limbs)
+		cmp = (a.m_num_limbs < b.m_num_limbs) ? -1 : 1;
+	for (size_t i = a.m_num_limbs; cmp == 0 && i-- > 0;)
+	{
+		limb_t x = a.GetLimb(i);
+		limb_t y = b.GetLimb(i);
+		if (x != y)
+			cmp = (x < y) ? -1 : 1;
+	}
+	return a.m_sign ? -cmp : cmp;
+}
+
+
+int BigIntView::Compare(const BigIntView& a, const BigInt& b)
+{
+	const BigIntLimbs& limbs = b.GetLimbs();
+	if (a.m_sign != b.GetSign())
+		return a.m_sign ? -1 : 1;
+	int cmp = 0;
+	if (a.m_num_limbs != limbs.size())
+		cmp = (a.m_num_limbs < limbs.size()) ? -1 : 1;
+	for (size_t i = a.m_num_limbs; cmp == 0 && i-- > 0;)
+	{
+		limb_t x = a.GetLimb(i);
+		if (x != limbs[i])
+			cmp = (x < limbs[i]) ? -1 : 1;
+	}
+	return a.m_sign ? -cmp : cmp;
+}
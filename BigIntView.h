@@ -0,0 +1,45 @@
+#pragma once
+
+#include "BigInt.h"
+
+// Read-only BigInt over its serialized form (see BigInt::Serialize) in a buffer owned by
+// someone else, e.g. a memory-mapped checkpoint: nothing is copied, limbs are loaded from
+// the bytes on access. The buffer must outlive the view.
+class BigIntView
+{
+public:
+	BigIntView() {}  // zero, not backed by a buffer
+	BigIntView(const uint8_t* data, size_t size);  // throws std::invalid_argument like BigInt::Deserialize
+
+	bool GetSign() const { return m_sign; }
+	size_t GetNumLimbs() const { return m_num_limbs; }
+	bool IsZero() const { return m_num_limbs == 0; }
+	size_t GetSerializedSize() const { return m_size; }  // the next value in the buffer starts here
+	BigInt::limb_t GetLimb(size_t i) const;  // i < GetNumLimbs(), as in BigInt::GetLimbs()
+	size_t BitLength() const;  // bits of |x|, 0 for zero
+	bool TestBit(size_t i) const;  // bit i of the two's complement of x, as BigInt::TestBit
+
+	BigInt ToBigInt() const;
+	std::string GetViewStr() const;
+	static int Compare(const BigIntView& a, const BigIntView& b);  // sign of a - b: -1, 0 or 1
+	static int Compare(const BigIntView& a, const BigInt& b);
+
+private:
+	const uint8_t* m_data = nullptr;  // the header
+	const uint8_t* m_limbs = nullptr;
+	size_t m_num_limbs = 0;
+	size_t m_size = 0;
+	bool m_sign = false;
+};
+
+
+inline bool operator<(const BigIntView& left, const BigIntView& right) { return BigIntView::Compare(left, right) < 0; }
+inline bool operator>(const BigIntView& left, const BigIntView& right) { return BigIntView::Compare(left, right) > 0; }
+inline bool operator<=(const BigIntView& left, const BigIntView& right) { return BigIntView::Compare(left, right) <= 0; }
+inline bool operator>=(const BigIntView& left, const BigIntView& right) { return BigIntView::Compare(left, right) >= 0; }
+inline bool operator==(const BigIntView& left, const BigIntView& right) { return BigIntView::Compare(left, right) == 0; }
+inline bool operator!=(const BigIntView& left, const BigIntView& right) { return BigIntView::Compare(left, right) != 0; }
+inline bool operator==(const BigIntView& left, const BigInt& right) { return BigIntView::Compare(left, right) == 0; }
+inline bool operator!=(const BigIntView& left, const BigInt& right) { return BigIntView::Compare(left, right) != 0; }
+inline bool operator==(const BigInt& left, const BigIntView& right) { return BigIntView::Compare(right, left) == 0; }
+inline bool operator!=(const BigInt& left, const BigIntView& right) { return BigIntView::Compare(right, left) != 0; }
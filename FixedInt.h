@@ -0,0 +1,360 @@
+#pragma once
+
+#include "BigInt.h"
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+// Signed integer of a width fixed at compile time, e.g. FixedInt<256>, for values whose size
+// is known in advance: the limbs live in the object, nothing allocates, and every operation
+// is constexpr over a constant number of limbs, so the compiler unrolls the loops. Values are
+// two's complement in [-2^(Bits-1), 2^(Bits-1)) and arithmetic wraps modulo 2^Bits as for
+// built-in integers; division truncates toward zero and the remainder has the sign of the
+// dividend, as for BigInt. Conversion to BigInt is exact, conversion from it throws
+// std::invalid_argument unless the value is in range.
+template<size_t Bits>
+class FixedInt
+{
+	static_assert(Bits > 0 && Bits % BigInt::LIMB_BITS == 0, "FixedInt: Bits must be a positive multiple of 32");
+
+public:
+	typedef BigInt::limb_t limb_t;
+	typedef BigInt::dlimb_t dlimb_t;
+	static const int LIMB_BITS = BigInt::LIMB_BITS;
+	static constexpr size_t NUM_LIMBS = Bits / LIMB_BITS;
+
+	constexpr FixedInt() {}
+	template<typename T, typename = BigIntIfWord<T, void>>
+	constexpr FixedInt(T i)
+	{
+		// sign-extended to the full width
+		bool negative = std::is_signed<T>::value && static_cast<int64_t>(i) < 0;
+		uint64_t bits = negative ? static_cast<uint64_t>(static_cast<int64_t>(i)) : static_cast<uint64_t>(i);
+		for (size_t k = 0; k < NUM_LIMBS; ++k)
+			m_limbs[k] = (k < 2) ? static_cast<limb_t>(bits >> (k * LIMB_BITS)) : (negative ? ~limb_t(0) : 0);
+	}
+	explicit FixedInt(const std::string& view_str) : FixedInt(BigInt(view_str)) {}  // throws as BigInt and when out of range
+	explicit FixedInt(const BigInt& x);
+
+	// getters
+	constexpr bool GetSign() const { return (m_limbs[NUM_LIMBS - 1] >> (LIMB_BITS - 1)) != 0; }
+	constexpr limb_t GetLimb(size_t i) const { return m_limbs[i]; }  // i < NUM_LIMBS, two's complement, least significant first
+	constexpr bool IsZero() const
+	{
+		for (size_t i = 0; i < NUM_LIMBS; ++i)
+		{
+			if (m_limbs[i] != 0)
+				return false;
+		}
+		return true;
+	}
+	static bool Fits(const BigInt& x);  // x is in [-2^(Bits-1), 2^(Bits-1))
+	BigInt ToBigInt() const;
+
+	// OPERATORS
+	// compound arithmetic, modulo 2^Bits
+	constexpr FixedInt& operator+=(const FixedInt& other)
+	{
+		limb_t carry = 0;
+		for (size_t i = 0; i < NUM_LIMBS; ++i)
+		{
+			dlimb_t t = static_cast<dlimb_t>(m_limbs[i]) + other.m_limbs[i] + carry;
+			m_limbs[i] = static_cast<limb_t>(t);
+			carry = static_cast<limb_t>(t >> LIMB_BITS);
+		}
+		return *this;
+	}
+
+	constexpr FixedInt& operator-=(const FixedInt& other)
+	{
+		limb_t borrow = 0;
+		for (size_t i = 0; i < NUM_LIMBS; ++i)
+		{
+			dlimb_t t = static_cast<dlimb_t>(m_limbs[i]) - other.m_limbs[i] - borrow;
+			m_limbs[i] = static_cast<limb_t>(t);
+			borrow = static_cast<limb_t>(t >> LIMB_BITS) & 1;
+		}
+		return *this;
+	}
+
+	constexpr FixedInt& operator*=(const FixedInt& other)
+	{
+		// the low half of the schoolbook product; two's complement needs no sign handling
+		Limbs r{};
+		for (size_t i = 0; i < NUM_LIMBS; ++i)
+		{
+			limb_t carry = 0;
+			for (size_t j = 0; i + j < NUM_LIMBS; ++j)
+			{
+				dlimb_t t = static_cast<dlimb_t>(m_limbs[i]) * other.m_limbs[j] + r[i + j] + carry;
+				r[i + j] = static_cast<limb_t>(t);
+				carry = static_cast<limb_t>(t >> LIMB_BITS);
+			}
+		}
+		m_limbs = r;
+		return *this;
+	}
+
+	constexpr FixedInt& operator/=(const FixedInt& other)  // throws std::domain_error if other == 0
+	{
+		FixedInt remainder;
+		DivMod(*this, other, *this, remainder);
+		return *this;
+	}
+
+	constexpr FixedInt& operator%=(const FixedInt& other)  // throws std::domain_error if other == 0
+	{
+		FixedInt quotient;
+		DivMod(*this, other, quotient, *this);
+		return *this;
+	}
+
+	// compound bitwise; >> rounds toward minus infinity, shifts by Bits or more leave 0 or -1
+	constexpr FixedInt& operator&=(const FixedInt& other) { for (size_t i = 0; i < NUM_LIMBS; ++i) m_limbs[i] &= other.m_limbs[i]; return *this; }
+	constexpr FixedInt& operator|=(const FixedInt& other) { for (size_t i = 0; i < NUM_LIMBS; ++i) m_limbs[i] |= other.m_limbs[i]; return *this; }
+	constexpr FixedInt& operator^=(const FixedInt& other) { for (size_t i = 0; i < NUM_LIMBS; ++i) m_limbs[i] ^= other.m_limbs[i]; return *this; }
+
+	constexpr FixedInt& operator<<=(size_t bits)
+	{
+		size_t limbs = (bits < Bits) ? bits / LIMB_BITS : NUM_LIMBS;
+		unsigned shift = bits % LIMB_BITS;
+		for (size_t i = NUM_LIMBS; i-- > 0;)
+		{
+			limb_t high = (i >= limbs) ? m_limbs[i - limbs] : 0;
+			limb_t low = (i >= limbs + 1) ? m_limbs[i - limbs - 1] : 0;
+			m_limbs[i] = (shift == 0) ? high : static_cast<limb_t>((high << shift) | (low >> (LIMB_BITS - shift)));
+		}
+		return *this;
+	}
+
+	constexpr FixedInt& operator>>=(size_t bits)
+	{
+		limb_t fill = GetSign() ? ~limb_t(0) : 0;
+		size_t limbs = (bits < Bits) ? bits / LIMB_BITS : NUM_LIMBS;
+		unsigned shift = bits % LIMB_BITS;
+		for (size_t i = 0; i < NUM_LIMBS; ++i)
+		{
+			limb_t low = (i + limbs < NUM_LIMBS) ? m_limbs[i + limbs] : fill;
+			limb_t high = (i + limbs + 1 < NUM_LIMBS) ? m_limbs[i + limbs + 1] : fill;
+			m_limbs[i] = (shift == 0) ? low : static_cast<limb_t>((low >> shift) | (high << (LIMB_BITS - shift)));
+		}
+		return *this;
+	}
+
+	// unary arithmetic
+	constexpr FixedInt operator-() const { FixedInt r = *this; r.Negate(); return r; }
+	constexpr FixedInt operator~() const { FixedInt r; for (size_t i = 0; i < NUM_LIMBS; ++i) r.m_limbs[i] = ~m_limbs[i]; return r; }
+	// increments/decrements
+	constexpr FixedInt& operator++() { return *this += FixedInt(1); }
+	constexpr FixedInt& operator--() { return *this -= FixedInt(1); }
+	constexpr FixedInt operator++(int) { FixedInt tmp = *this; ++*this; return tmp; }
+	constexpr FixedInt operator--(int) { FixedInt tmp = *this; --*this; return tmp; }
+
+	// methods
+	constexpr void Negate() { *this = ~*this; ++*this; }  // -(-2^(Bits-1)) wraps to itself
+	constexpr FixedInt Abs() const { return GetSign() ? -*this : *this; }
+	static constexpr int Compare(const FixedInt& a, const FixedInt& b)  // sign of a - b: -1, 0 or 1
+	{
+		if (a.GetSign() != b.GetSign())
+			return a.GetSign() ? -1 : 1;
+		// same sign: two's complement orders like the unsigned limbs
+		for (size_t i = NUM_LIMBS; i-- > 0;)
+		{
+			if (a.m_limbs[i] != b.m_limbs[i])
+				return (a.m_limbs[i] < b.m_limbs[i]) ? -1 : 1;
+		}
+		return 0;
+	}
+	// quotient truncated toward zero and remainder with the sign of a; throws std::domain_error if b == 0
+	static constexpr void DivMod(const FixedInt& a, const FixedInt& b, FixedInt& quotient, FixedInt& remainder)
+	{
+		if (b.IsZero())
+			throw std::domain_error("FixedInt division by zero");
+		bool a_negative = a.GetSign();
+		bool b_negative = b.GetSign();
+		// magnitudes as unsigned limbs: the magnitude of -2^(Bits-1) is its own bit pattern
+		Limbs q{};
+		Limbs r{};
+		DivRemAbs(a.Abs().m_limbs, b.Abs().m_limbs, q, r);
+		quotient.m_limbs = q;
+		remainder.m_limbs = r;
+		if (a_negative != b_negative)
+			quotient.Negate();
+		if (a_negative)
+			remainder.Negate();
+	}
+
+	// viewing, through BigInt
+	std::string GetViewStr() const { return ToBigInt().GetViewStr(); }
+	friend std::ostream& operator<<(std::ostream& stream, const FixedInt& x) { return stream << x.ToBigInt(); }
+
+	// binary operators; built-in integers convert implicitly
+	friend constexpr FixedInt operator+(FixedInt left, const FixedInt& right) { return left += right; }
+	friend constexpr FixedInt operator-(FixedInt left, const FixedInt& right) { return left -= right; }
+	friend constexpr FixedInt operator*(FixedInt left, const FixedInt& right) { return left *= right; }
+	friend constexpr FixedInt operator/(FixedInt left, const FixedInt& right) { return left /= right; }
+	friend constexpr FixedInt operator%(FixedInt left, const FixedInt& right) { return left %= right; }
+	friend constexpr FixedInt operator&(FixedInt left, const FixedInt& right) { return left &= right; }
+	friend constexpr FixedInt operator|(FixedInt left, const FixedInt& right) { return left |= right; }
+	friend constexpr FixedInt operator^(FixedInt left, const FixedInt& right) { return left ^= right; }
+	friend constexpr FixedInt operator<<(FixedInt x, size_t bits) { return x <<= bits; }
+	friend constexpr FixedInt operator>>(FixedInt x, size_t bits) { return x >>= bits; }
+	// comparison
+	friend constexpr bool operator==(const FixedInt& left, const FixedInt& right)
+	{
+		for (size_t i = 0; i < NUM_LIMBS; ++i)
+		{
+			if (left.m_limbs[i] != right.m_limbs[i])
+				return false;
+		}
+		return true;
+	}
+	friend constexpr bool operator!=(const FixedInt& left, const FixedInt& right) { return !(left == right); }
+	friend constexpr bool operator<(const FixedInt& left, const FixedInt& right) { return Compare(left, right) < 0; }
+	friend constexpr bool operator>(const FixedInt& left, const FixedInt& right) { return Compare(left, right) > 0; }
+	friend constexpr bool operator<=(const FixedInt& left, const FixedInt& right) { return Compare(left, right) <= 0; }
+	friend constexpr bool operator>=(const FixedInt& left, const FixedInt& right) { return Compare(left, right) >= 0; }
+
+private:
+	typedef std::array<limb_t, NUM_LIMBS> Limbs;
+
+	static constexpr size_t Normalized(const Limbs& a)  // limbs without the heading zeroes
+	{
+		size_t n = NUM_LIMBS;
+		while (n > 0 && a[n - 1] == 0)
+			--n;
+		return n;
+	}
+
+	static constexpr int CountLeadingZeros(limb_t x)  // x != 0; a loop, builtins are not constexpr everywhere
+	{
+		int n = 0;
+		for (limb_t bit = limb_t(1) << (LIMB_BITS - 1); (x & bit) == 0; bit >>= 1)
+			++n;
+		return n;
+	}
+
+	// q = a / b, r = a % b on unsigned limbs, b != 0: Knuth's Algorithm D on the significant limbs
+	static constexpr void DivRemAbs(const Limbs& a, const Limbs& b, Limbs& q, Limbs& r)
+	{
+		size_t na = Normalized(a);
+		size_t nb = Normalized(b);
+		if (na < nb)
+		{
+			r = a;
+			return;
+		}
+		if (nb == 1)
+		{
+			dlimb_t rem = 0;
+			for (size_t i = na; i-- > 0;)
+			{
+				dlimb_t t = (rem << LIMB_BITS) | a[i];
+				q[i] = static_cast<limb_t>(t / b[0]);
+				rem = t % b[0];
+			}
+			r[0] = static_cast<limb_t>(rem);
+			return;
+		}
+
+		if constexpr (NUM_LIMBS > 1)  // single-limb widths never get here
+		{
+			// normalize so that the top limb of the divisor has its high bit set
+			int shift = CountLeadingZeros(b[nb - 1]);
+			Limbs v{};
+			std::array<limb_t, NUM_LIMBS + 1> u{};
+			for (size_t i = nb; i-- > 0;)
+				v[i] = static_cast<limb_t>((b[i] << shift) | ((shift != 0 && i > 0) ? b[i - 1] >> (LIMB_BITS - shift) : 0));
+			u[na] = (shift != 0) ? a[na - 1] >> (LIMB_BITS - shift) : 0;
+			for (size_t i = na; i-- > 0;)
+				u[i] = static_cast<limb_t>((a[i] << shift) | ((shift != 0 && i > 0) ? a[i - 1] >> (LIMB_BITS - shift) : 0));
+
+			const dlimb_t base = dlimb_t(1) << LIMB_BITS;
+			for (size_t j = na - nb + 1; j-- > 0;)
+			{
+				// estimate from the top two limbs, off by at most one after the correction
+				dlimb_t top = (static_cast<dlimb_t>(u[j + nb]) << LIMB_BITS) | u[j + nb - 1];
+				dlimb_t qhat = top / v[nb - 1];
+				dlimb_t rhat = top % v[nb - 1];
+				while (qhat >= base || qhat * v[nb - 2] > ((rhat << LIMB_BITS) | u[j + nb - 2]))
+				{
+					--qhat;
+					rhat += v[nb - 1];
+					if (rhat >= base)
+						break;
+				}
+
+				// u[j..j+nb] -= qhat * v
+				limb_t carry = 0;
+				limb_t borrow = 0;
+				for (size_t i = 0; i < nb; ++i)
+				{
+					dlimb_t p = qhat * v[i] + carry;
+					carry = static_cast<limb_t>(p >> LIMB_BITS);
+					dlimb_t t = static_cast<dlimb_t>(u[i + j]) - static_cast<limb_t>(p) - borrow;
+					u[i + j] = static_cast<limb_t>(t);
+					borrow = static_cast<limb_t>(t >> LIMB_BITS) & 1;
+				}
+				dlimb_t t = static_cast<dlimb_t>(u[j + nb]) - carry - borrow;
+				u[j + nb] = static_cast<limb_t>(t);
+
+				// negative: qhat was one too large, add v back
+				if ((t >> LIMB_BITS) != 0)
+				{
+					--qhat;
+					limb_t c = 0;
+					for (size_t i = 0; i < nb; ++i)
+					{
+						dlimb_t s = static_cast<dlimb_t>(u[i + j]) + v[i] + c;
+						u[i + j] = static_cast<limb_t>(s);
+						c = static_cast<limb_t>(s >> LIMB_BITS);
+					}
+					u[j + nb] += c;
+				}
+				q[j] = static_cast<limb_t>(qhat);
+			}
+
+			// the remainder is the low nb limbs of u, shifted back
+			for (size_t i = 0; i < nb; ++i)
+				r[i] = static_cast<limb_t>((u[i] >> shift) | ((shift != 0) ? u[i + 1] << (LIMB_BITS - shift) : 0));
+		}
+	}
+
+private:
+	Limbs m_limbs{};  // two's complement, least significant limb first
+};
+
+
+template<size_t Bits>
+FixedInt<Bits>::FixedInt(const BigInt& x)
+{
+	if (!Fits(x))
+		throw std::invalid_argument("FixedInt: a value of " + std::to_string(x.BitLength()) + " bits does not fit in " + std::to_string(Bits));
+	const BigIntLimbs& limbs = x.GetLimbs();
+	for (size_t i = 0; i < limbs.size(); ++i)
+		m_limbs[i] = limbs[i];
+	if (x.GetSign())
+		Negate();
+}
+
+
+template<size_t Bits>
+bool FixedInt<Bits>::Fits(const BigInt& x)
+{
+	// |x| < 2^(Bits-1), or x == -2^(Bits-1)
+	size_t bits = x.BitLength();
+	return bits < Bits || (x.GetSign() && bits == Bits && x.TrailingZeros() == Bits - 1);
+}
+
+
+template<size_t Bits>
+BigInt FixedInt<Bits>::ToBigInt() const
+{
+	// Abs() of the minimum is itself, whose bits read unsigned are its magnitude
+	FixedInt magnitude = Abs();
+	BigInt x = BigInt::FromLimbs(magnitude.m_limbs.data(), NUM_LIMBS);
+	if (GetSign())
+		x.Negate();
+	return x;
+}
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BigInt.h"
+#include "BigIntExpr.h"
+#include "FixedInt.h"
+
+// Performance suite of the BigInt operations in the manner of Google Benchmark:
+// every case is repeated until it has run for the minimum time, the console gets
+// a table and --json writes the Google Benchmark JSON schema, so that the usual
+// comparison tools can track regressions between two runs.
+//
+// usage: benchmark [--filter=substring] [--max_digits=N] [--min_time=seconds] [--threads=N] [--json=file]
+
+using namespace std;
+
+namespace
+{
+	struct Options
+	{
+		string filter;  // run only the cases whose name contains it
+		size_t max_digits = 1000000;
+		double min_time = 0.2;  // seconds per case
+		size_t threads = 1;  // BigInt::SetNumThreads
+		string json_path;
+	};
+
+
+	struct Result
+	{
+		string name;
+		size_t iterations;
+		double real_ns;  // per operation
+		double cpu_ns;
+		size_t digits;  // decimal digits processed by one operation
+	};
+
+
+	volatile size_t sink;  // keeps the results observable
+
+
+	string RandomDigits(mt19937_64& rng, size_t n)
+	{
+		string s(n, '0');
+		for (size_t i = 0; i < n; ++i)
+			s[i] = static_cast<char>('0' + rng() % 10);
+		if (s[0] == '0')
+			s[0] = '1';
+		return s;
+	}
+
+
+	// runs op in growing batches until one batch takes min_time, as Google Benchmark does
+	template<typename Op>
+	Result Run(const string& name, size_t digits, const Options& options, Op op)
+	{
+		typedef chrono::steady_clock Clock;
+		size_t iterations = 1;
+		for (;;)
+		{
+			clock_t cpu_start = clock();
+			Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < iterations; ++i)
+				op();
+			double elapsed = chrono::duration<double>(Clock::now() - start).count();
+			double cpu_elapsed = static_cast<double>(clock() - cpu_start) / CLOCKS_PER_SEC;
+			if (elapsed >= options.min_time || iterations >= (size_t(1) << 30))
+				return Result{ name, iterations, elapsed * 1e9 / iterations, cpu_elapsed * 1e9 / iterations, digits };
+
+			// aim a bit above min_time, grow at most tenfold per step
+			double factor = (elapsed > 0) ? 1.4 * options.min_time / elapsed : 10.0;
+			size_t next = static_cast<size_t>(static_cast<double>(iterations) * min(factor, 10.0));
+			iterations = max(iterations + 1, next);
+		}
+	}
+
+
+	class Suite
+	{
+	public:
+		explicit Suite(const Options& options) :
+			m_options(options),
+			m_rng(12345)
+		{}
+
+		template<typename Op>
+		void Add(const string& name, size_t digits, Op op)
+		{
+			if (name.find(m_options.filter) == string::npos)
+				return;
+			Result r = Run(name, digits, m_options, op);
+			printf("%-28s %16.1f ns %16.1f ns %12zu %14.4g\n", r.name.c_str(), r.real_ns, r.cpu_ns, r.iterations,
+				DigitsPerSecond(r));
+			fflush(stdout);
+			m_results.push_back(r);
+		}
+
+		BigInt Random(size_t digits) { return BigInt(RandomDigits(m_rng, digits)); }
+		string RandomString(size_t digits) { return RandomDigits(m_rng, digits); }
+
+		static double DigitsPerSecond(const Result& r) { return static_cast<double>(r.digits) * 1e9 / r.real_ns; }
+
+		bool WriteJson(const string& path) const
+		{
+			ofstream out(path);
+			if (!out)
+				return false;
+			const BigIntThresholds& t = BigInt::Thresholds();
+			out << "{\n  \"context\": {\n";
+			out << "    \"library\": \"BigInt\",\n";
+			out << "    \"min_time\": " << m_options.min_time << ",\n";
+			out << "    \"max_digits\": " << m_options.max_digits << ",\n";
+			out << "    \"threads\": " << BigInt::GetNumThreads() << ",\n";
+			out << "    \"mul_karatsuba\": " << t.mul_karatsuba << ",\n";
+			out << "    \"mul_toom3\": " << t.mul_toom3 << ",\n";
+			out << "    \"mul_ntt\": " << t.mul_ntt << ",\n";
+			out << "    \"div_bz\": " << t.div_bz << ",\n";
+			out << "    \"conv_dc\": " << t.conv_dc << ",\n";
+			out << "    \"mul_parallel\": " << t.mul_parallel << "\n";
+			out << "  },\n  \"benchmarks\": [\n";
+			for (size_t i = 0; i < m_results.size(); ++i)
+			{
+				const Result& r = m_results[i];
+				out << "    {\n";
+				out << "      \"name\": \"" << r.name << "\",\n";
+				out << "      \"run_name\": \"" << r.name << "\",\n";
+				out << "      \"run_type\": \"iteration\",\n";
+				out << "      \"iterations\": " << r.iterations << ",\n";
+				out << "      \"real_time\": " << r.real_ns << ",\n";
+				out << "      \"cpu_time\": " << r.cpu_ns << ",\n";
+				out << "      \"time_unit\": \"ns\",\n";
+				out << "      \"digits_per_second\": " << DigitsPerSecond(r) << "\n";
+				out << "    }" << ((i + 1 < m_results.size()) ? "," : "") << "\n";
+			}
+			out << "  ]\n}\n";
+			return static_cast<bool>(out);
+		}
+
+	private:
+		const Options& m_options;
+		mt19937_64 m_rng;
+		vector<Result> m_results;
+	};
+
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			string arg = argv[i];
+			size_t eq = arg.find('=');
+			if (eq == string::npos)
+				return false;
+			string key = arg.substr(0, eq);
+			string value = arg.substr(eq + 1);
+			if (key == "--filter")
+				options.filter = value;
+			else if (key == "--max_digits")
+				options.max_digits = stoul(value);
+			else if (key == "--min_time")
+				options.min_time = stod(value);
+			else if (key == "--threads")
+				options.threads = stoul(value);
+			else if (key == "--json")
+				options.json_path = value;
+			else
+				return false;
+		}
+		return true;
+	}
+
+
+	string Name(const string& op, size_t a)
+	{
+		return op + "/" + to_string(a);
+	}
+
+
+	string Name(const string& op, size_t a, size_t b)
+	{
+		return op + "/" + to_string(a) + "x" + to_string(b);
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		if (!ParseOptions(argc, argv, options))
+		{
+			cerr << "usage: " << argv[0] << " [--filter=substring] [--max_digits=N] [--min_time=seconds] [--threads=N] [--json=file]" << endl;
+			return 1;
+		}
+	}
+	catch (const exception&)
+	{
+		cerr << "invalid option value" << endl;
+		return 1;
+	}
+
+	BigInt::SetNumThreads(options.threads);
+	printf("%-28s %19s %19s %12s %14s\n", "Benchmark", "Time", "CPU", "Iterations", "Digits/s");
+	printf("%s\n", string(96, '-').c_str());
+
+	Suite suite(options);
+	// operand sizes in decimal digits; balanced shapes use equal sizes,
+	// unbalanced ones a second operand ten times shorter
+	for (size_t n = 1; n <= options.max_digits; n *= 10)
+	{
+		size_t m = max<size_t>(n / 10, 1);
+		BigInt a = suite.Random(n);
+		BigInt b = suite.Random(n);
+		BigInt c = suite.Random(m);
+		BigInt wide = suite.Random(2 * n);
+		BigInt a_copy = a;
+		string text = suite.RandomString(n);
+
+		suite.Add(Name("add", n), n, [&] { sink = (a + b).GetNumLimbs(); });
+		suite.Add(Name("sub", n), n, [&] { sink = (a - b).GetNumLimbs(); });
+		suite.Add(Name("mul", n, n), 2 * n, [&] { sink = (a * b).GetNumLimbs(); });
+		suite.Add(Name("and", n), n, [&] { sink = (a & b).GetNumLimbs(); });
+		suite.Add(Name("xor", n), n, [&] { sink = (a ^ b).GetNumLimbs(); });
+		suite.Add(Name("shl", n), n, [&] { sink = (a << 77).GetNumLimbs(); });
+		suite.Add(Name("shr", n), n, [&] { sink = (a >> 77).GetNumLimbs(); });
+		// single-word operands, as in counters and scaling
+		suite.Add(Name("add_word", n), n, [&] { sink = (a + 1).GetNumLimbs(); });
+		suite.Add(Name("mul_word", n), n, [&] { sink = (a * 10).GetNumLimbs(); });
+		suite.Add(Name("div_word", n), n, [&] { sink = (a / 10).GetNumLimbs(); });
+		suite.Add(Name("mod_word", n), n, [&] { sink = (a % 1000000007).GetNumLimbs(); });
+		// a * b + c * d - e with a temporary per operator, and fused into a reused destination
+		BigInt fused;
+		suite.Add(Name("sum_of_products", n), 2 * n, [&] { sink = (a * b + c * a - b).GetNumLimbs(); });
+		suite.Add(Name("sum_of_products_lazy", n), 2 * n, [&] { fused = BigIntLazy(a) * b + BigIntLazy(c) * a - b; sink = fused.GetNumLimbs(); });
+		if (n <= 10000)
+		{
+			// Horner steps at a word point: acc * x + coefficient
+			suite.Add(Name("horner", n), n, [&] { BigInt acc = a; for (int i = 0; i < 16; ++i) acc = acc * 1000003 + b; sink = acc.GetNumLimbs(); });
+			suite.Add(Name("horner_lazy", n), n, [&] { BigInt acc = a; for (int i = 0; i < 16; ++i) acc = BigIntLazy(acc) * 1000003 + b; sink = acc.GetNumLimbs(); });
+		}
+		suite.Add(Name("div", 2 * n, n), 2 * n, [&] { sink = (wide / a).GetNumLimbs(); });
+		suite.Add(Name("mod", 2 * n, n), 2 * n, [&] { sink = (wide % a).GetNumLimbs(); });
+		if (m < n)
+		{
+			suite.Add(Name("mul", n, m), n + m, [&] { sink = (a * c).GetNumLimbs(); });
+			suite.Add(Name("div", n, m), n, [&] { sink = (a / c).GetNumLimbs(); });
+			suite.Add(Name("mod", n, m), n, [&] { sink = (a % c).GetNumLimbs(); });
+		}
+		suite.Add(Name("isqrt", n), n, [&] { sink = BigInt::ISqrt(a).GetNumLimbs(); });
+		suite.Add(Name("iroot5", n), n, [&] { sink = BigInt::IRoot(a, 5).GetNumLimbs(); });
+		suite.Add(Name("is_square", n), n, [&] { sink = BigInt::IsPerfectSquare(a); });  // rejected by the residues
+		suite.Add(Name("gcd", n), n, [&] { sink = BigInt::Gcd(a, b).GetNumLimbs(); });
+		suite.Add(Name("gcd_ext", n), n, [&] { BigInt x, y; sink = BigInt::ExtendedGcd(a, b, x, y).GetNumLimbs(); });
+		// here n is the argument, not a size in digits
+		unsigned arg = static_cast<unsigned>(n);
+		suite.Add(Name("factorial", n), n, [&] { sink = BigInt::Factorial(arg).GetNumLimbs(); });
+		suite.Add(Name("binomial", 2 * n, n), n, [&] { sink = BigInt::Binomial(2 * arg, arg).GetNumLimbs(); });
+		suite.Add(Name("primorial", n), n, [&] { sink = BigInt::Primorial(arg).GetNumLimbs(); });
+		if (n <= 1000)
+		{
+			// exponent and modulus of n digits: Montgomery for the odd modulus, Barrett for the even one
+			BigInt odd = b + (b % 2 == 0 ? 1 : 0);
+			BigInt even = odd + 1;
+			suite.Add(Name("powmod_odd", n), n, [&] { sink = BigInt::PowMod(a, b, odd).GetNumLimbs(); });
+			suite.Add(Name("powmod_even", n), n, [&] { sink = BigInt::PowMod(a, b, even).GetNumLimbs(); });
+		}
+		suite.Add(Name("less", n), n, [&] { sink = (a < a_copy); });  // equal values scan every limb
+		suite.Add(Name("equal", n), n, [&] { sink = (a == a_copy); });
+		if (n <= 1000)
+		{
+			// runs of equal and nearly equal values, as in sorting and dedup
+			vector<BigInt> values;
+			for (int i = 0; i < 1000; ++i)
+				values.push_back(a + (i * 7919 % 100));
+			suite.Add(Name("sort_unique", n), n * values.size(), [&]
+			{
+				vector<BigInt> v = values;
+				sort(v.begin(), v.end());
+				sink = unique(v.begin(), v.end()) - v.begin();
+			});
+		}
+		suite.Add(Name("parse", n), n, [&] { sink = BigInt(text).GetNumLimbs(); });
+		suite.Add(Name("print", n), n, [&] { sink = a.GetViewStr().size(); });
+		suite.Add(Name("read", n), n, [&] { istringstream in(text); BigInt x; in >> x; sink = x.GetNumLimbs(); });
+		suite.Add(Name("write", n), n, [&] { size_t chars = 0; a.WriteDecimal([&](const char*, size_t k) { chars += k; }); sink = chars; });
+		// into a reused buffer; hex is bit extraction, decimal the radix conversion
+		vector<char> chars(a.DigitCountUpperBound(2));
+		string hex(chars.data(), a.ToChars(chars.data(), chars.data() + chars.size(), 16).ptr);
+		suite.Add(Name("to_chars", n), n, [&] { sink = a.ToChars(chars.data(), chars.data() + chars.size()).ptr - chars.data(); });
+		suite.Add(Name("to_chars_hex", n), n, [&] { sink = a.ToChars(chars.data(), chars.data() + chars.size(), 16).ptr - chars.data(); });
+		suite.Add(Name("from_chars", n), n, [&] { BigInt x; BigInt::FromChars(text.data(), text.data() + text.size(), x); sink = x.GetNumLimbs(); });
+		suite.Add(Name("from_chars_hex", n), n, [&] { BigInt x; BigInt::FromChars(hex.data(), hex.data() + hex.size(), x, 16); sink = x.GetNumLimbs(); });
+		vector<uint8_t> bytes = a.Serialize();
+		suite.Add(Name("serialize", n), n, [&] { sink = a.Serialize().size(); });
+		suite.Add(Name("deserialize", n), n, [&] { sink = BigInt::Deserialize(bytes.data(), bytes.size()).GetNumLimbs(); });
+	}
+
+	// the same operations on 256-bit values held on the stack, next to the BigInt ones above;
+	// the product of two 38-digit operands fits without wrapping
+	{
+		typedef FixedInt<256> Int256;
+		BigInt a = suite.Random(38);
+		BigInt b = suite.Random(38);
+		BigInt c = suite.Random(20);
+		Int256 fa(a), fb(b | 1), fc(c);
+		// every iteration depends on the previous one so the compiler cannot hoist the work
+		Int256 fx = fa;
+		const size_t top = Int256::NUM_LIMBS - 1;
+		suite.Add("fixed256_add", 38, [&] { fx += fb; sink = fx.GetLimb(top); });
+		suite.Add("fixed256_mul", 76, [&] { fx *= fb; sink = fx.GetLimb(top); });  // odd fb: never reaches 0
+		suite.Add("fixed256_div", 76, [&] { sink = ((fa * fb + Int256(sink & 1)) / fc).GetLimb(0); });
+		suite.Add("bigint256_add", 38, [&] { sink = (a + b).GetNumLimbs(); });
+		suite.Add("bigint256_mul", 76, [&] { sink = (a * b).GetNumLimbs(); });
+		suite.Add("bigint256_div", 76, [&] { sink = ((a * b) / c).GetNumLimbs(); });
+	}
+
+	if (!options.json_path.empty() && !suite.WriteJson(options.json_path))
+	{
+		cerr << "cannot write " << options.json_path << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -1,6 +1,11 @@
 #include <iostream>
 #include <map>
+#include <sstream>
 #include "BigInt.h"
+#include "BigIntExpr.h"
+#include "BigIntModular.h"
+#include "BigIntView.h"
+#include "FixedInt.h"
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -128,6 +133,30 @@ void test_comparison(const BigInt& left, const BigInt& right, const std::string&
 }
 
 
+void test_view_str(const std::string& view_str, const std::string& expected)
+{
+	cout << "BigInt(\"" << view_str.substr(0, 40) << (view_str.size() > 40 ? "...\")" : "\")") << ".GetViewStr()";
+	std::string result = BigInt(view_str).GetViewStr();
+	print_test_result<bool>(result == expected, true);
+}
+
+
+void test_invalid_view_str(const std::string& view_str)
+{
+	cout << "BigInt(\"" << view_str << "\") throws";
+	bool thrown = false;
+	try
+	{
+		BigInt x(view_str);
+	}
+	catch (const std::invalid_argument&)
+	{
+		thrown = true;
+	}
+	print_test_result<bool>(thrown, true);
+}
+
+
 int main()
 {
 	BigInt x("12345");
@@ -153,6 +182,10 @@ int main()
 	test_compound_arithmetic(x, BigInt(-12), "+=", BigInt("-12357"));
 	x = BigInt("392992536972");
 	test_compound_arithmetic(x, BigInt("654987561620"), "+=", BigInt("1047980098592"));
+	x = BigInt("4294967295");
+	test_compound_arithmetic(x, 1, "+=", BigInt("4294967296"));
+	x = BigInt("18446744073709551615");
+	test_compound_arithmetic(x, 1, "+=", BigInt("18446744073709551616"));
 
 	// testing -=
 	BigInt a(12345);
@@ -179,6 +212,10 @@ int main()
 	test_compound_arithmetic(a, 2708, "-=", BigInt(46386 - 2708));
 	a = BigInt(-976286);
 	test_compound_arithmetic(a, 22773, "-=", BigInt(-976286 - 22773));
+	a = BigInt("18446744073709551616");
+	test_compound_arithmetic(a, 1, "-=", BigInt("18446744073709551615"));
+	a = BigInt("-2147483648");
+	test_compound_arithmetic(a, -2147483647 - 1, "-=", BigInt(0));
 
 
 	a = BigInt(12345);
@@ -195,6 +232,8 @@ int main()
 	test_compound_arithmetic(a, BigInt("65498756162"), "*=", BigInt("42891632034285021531383997316992"));
 	a = BigInt("898756213212987956216245987562162654956865168765651");
 	test_compound_arithmetic(a, -8, "*=", BigInt("-7190049705703903649729967900497301239654921350125208"));
+	a = BigInt("18446744073709551616");
+	test_compound_arithmetic(a, BigInt("18446744073709551616"), "*=", BigInt("340282366920938463463374607431768211456"));
 
 
 	cout << "testing divide and modulo" << endl;
@@ -252,6 +291,19 @@ int main()
 	test_compound_arithmetic(a, -6277, "/=", BigInt(-549875 / -6277));
 	a = BigInt(-549875);
 	test_compound_arithmetic(a, -6277, "%=", BigInt(-549875 % -6277));
+	a = BigInt("340282366920938463463374607431768211457");
+	test_compound_arithmetic(a, BigInt("18446744073709551616"), "/=", BigInt("18446744073709551616"));
+	a = BigInt("-340282366920938463463374607431768211457");
+	test_compound_arithmetic(a, BigInt("18446744073709551616"), "%=", BigInt(-1));
+	a = BigInt("1000000000000000000000000000000000000000000000000000000000012345");
+	test_compound_arithmetic(a, BigInt("100000000000000000007"), "/=", BigInt("9999999999999999999300000000000000000048999"));
+	a = BigInt("-1000000000000000000000000000000000000000000000000000000000012345");
+	test_compound_arithmetic(a, BigInt("100000000000000000007"), "%=", BigInt("-99999999999999669352"));
+	// quotient limb estimate is one too large here and needs the add-back step
+	a = BigInt("170141183420855150474555134919112130560");
+	test_compound_arithmetic(a, BigInt("39614081275578912866186559489"), "/=", BigInt("4294967293"));
+	a = BigInt("170141183420855150474555134919112130560");
+	test_compound_arithmetic(a, BigInt("39614081275578912866186559489"), "%=", BigInt("73786976277658337283"));
 
 
 	cout << "testing binary arithmetic" << endl;
@@ -269,11 +321,635 @@ int main()
 	test_binary_arithmetic(-12345, 12, "*", BigInt(-12345 * 12));
 	test_binary_arithmetic(12, 1234567, "*", BigInt(12 * 1234567));
 	test_binary_arithmetic(BigInt("-5642321987565423217"), BigInt("-685421578954621"), "*", BigInt("3867369245687467817725668302835757"));
+	// (10^k - 1)^2 = 10^2k - 2 * 10^k + 1: large enough for Karatsuba and Toom-3
+	test_binary_arithmetic(BigInt(std::string(1500, '9')), BigInt(std::string(1500, '9')), "*",
+		BigInt(std::string(1499, '9') + "8" + std::string(1499, '0') + "1"));
+	// (10^a - 1) * (10^b - 1) with a >> b: unbalanced operands
+	test_binary_arithmetic(BigInt(std::string(1500, '9')), BigInt(std::string(400, '9')), "*",
+		BigInt(std::string(399, '9') + "8" + std::string(1100, '9') + std::string(399, '0') + "1"));
+	{
+		// same products through the number-theoretic transform
+		BigIntThresholds saved = BigInt::Thresholds();
+		BigInt::Thresholds().mul_ntt = BigInt::Thresholds().mul_karatsuba;
+		test_binary_arithmetic(BigInt(std::string(1500, '9')), BigInt(std::string(1500, '9')), "*",
+			BigInt(std::string(1499, '9') + "8" + std::string(1499, '0') + "1"));
+		test_binary_arithmetic(BigInt(std::string(1500, '9')), BigInt("-" + std::string(400, '9')), "*",
+			BigInt("-" + std::string(399, '9') + "8" + std::string(1100, '9') + std::string(399, '0') + "1"));
+		BigInt::Thresholds() = saved;
+	}
+	{
+		// Toom-3, Karatsuba and the transform split over a thread pool
+		BigIntThresholds saved = BigInt::Thresholds();
+		BigInt::SetNumThreads(4);
+		BigInt::Thresholds().mul_parallel = BigInt::Thresholds().mul_karatsuba;
+		test_binary_arithmetic(BigInt(std::string(1500, '9')), BigInt(std::string(1500, '9')), "*",
+			BigInt(std::string(1499, '9') + "8" + std::string(1499, '0') + "1"));
+		BigInt::Thresholds().mul_ntt = BigInt::Thresholds().mul_karatsuba;
+		test_binary_arithmetic(BigInt(std::string(1500, '9')), BigInt(std::string(1500, '9')), "*",
+			BigInt(std::string(1499, '9') + "8" + std::string(1499, '0') + "1"));
+		BigInt::SetNumThreads(1);
+		BigInt::Thresholds() = saved;
+	}
 	test_binary_arithmetic(12345, 12, "/", BigInt(12345 / 12));
 	test_binary_arithmetic(-12345, 12, "/", BigInt(-12345 / 12));
 	test_binary_arithmetic(12345, 12, "%", BigInt(12345 % 12));
 	test_binary_arithmetic(-12345, 12, "%", BigInt(-12345 % 12));
+	// ((10^k - 1)^2 + 12345) divided by 10^k - 1: large enough for recursive division
+	test_binary_arithmetic(BigInt(std::string(1499, '9') + "8" + std::string(1495, '0') + "12346"), BigInt(std::string(1500, '9')), "/",
+		BigInt(std::string(1500, '9')));
+	test_binary_arithmetic(BigInt(std::string(1499, '9') + "8" + std::string(1495, '0') + "12346"), BigInt(std::string(1500, '9')), "%",
+		BigInt(12345));
+
+
+	cout << "testing string conversion" << endl;
+	test_view_str("-0", "0");
+	test_view_str("+000123", "123");
+	test_view_str("1000000000", "1000000000");
+	{
+		// long enough for divide and conquer, with zero runs across the split points
+		std::string digits = "1" + std::string(2000, '0');
+		for (int i = 0; i < 300; ++i)
+			digits += "123456789";
+		digits += std::string(700, '0') + "42";
+		test_view_str(digits, digits);
+		test_view_str("-" + digits, "-" + digits);
+	}
+	test_invalid_view_str("");
+	test_invalid_view_str("-");
+	test_invalid_view_str("12a45");
+	test_invalid_view_str(" 12");
+	test_invalid_view_str("--12");
+
+	cout << "testing temporaries and moves" << endl;
+	{
+		BigInt a(12345), b(-12);
+		cout << "(a + b) * (a - b) - a * a";
+		print_test_result<BigInt>((a + b) * (a - b) - a * a, BigInt(-144));
+		cout << "a - b * 1000";
+		print_test_result<BigInt>(a - b * 1000, BigInt(24345));
+		cout << "-(a * b) + b";
+		print_test_result<BigInt>(-(a * b) + b, BigInt(148128));
+		cout << "(b * b).Abs() % (a - 12300)";
+		print_test_result<BigInt>((b * b).Abs() % (a - 12300), BigInt(144 % 45));
+		BigInt c(std::move(a));
+		cout << "moved-from value";
+		print_test_result<BigInt>(a, BigInt(0));
+		a = std::move(c);
+		cout << "move assignment";
+		print_test_result<BigInt>(a, BigInt(12345));
+	}
+
+	cout << "testing small values" << endl;
+	{
+		// results crossing 64 bits and the four inline limbs in both directions
+		BigInt a("18446744073709551615"), b("4294967295");
+		test_binary_arithmetic(a, a, "+", BigInt("36893488147419103230"));
+		test_binary_arithmetic(b, b, "*", BigInt("18446744065119617025"));
+		test_binary_arithmetic(a, b, "*", BigInt("79228162495817593515539431425"));
+		test_binary_arithmetic(BigInt("18446744073709551616"), 1, "-", a);
+		test_binary_arithmetic(1, BigInt("18446744073709551616"), "-", -a);
+		test_binary_arithmetic(a, b, "/", BigInt("4294967297"));
+		test_binary_arithmetic(-a, BigInt("10000000000"), "%", BigInt("-3709551615"));
+		test_comparison(BigInt("18446744069414584320"), BigInt("4294967296"), ">", true);
+		test_comparison(-a, -b, "<", true);
+		BigInt c("340282366920938463463374607431768211455");
+		test_binary_arithmetic(c, 1, "+", BigInt("340282366920938463463374607431768211456"));
+		test_binary_arithmetic(c, BigInt("18446744073709551617"), "+", BigInt("340282366920938463481821351505477763072"));
+		test_binary_arithmetic(a, a, "*", BigInt("340282366920938463426481119284349108225"));
+		test_binary_arithmetic(c, BigInt("18446744073709551616"), "-", BigInt("340282366920938463444927863358058659839"));
+		test_binary_arithmetic(BigInt("18446744073709551616"), c, "-", BigInt("-340282366920938463444927863358058659839"));
+		test_comparison(c, BigInt("340282366920938463444927863358058659839"), ">", true);
+		test_comparison(-c, BigInt("-340282366920938463444927863358058659839"), "<", true);
+	}
+
+	cout << "testing arena allocation" << endl;
+	{
+		BigInt expected(1);
+		for (int i = 2; i <= 300; ++i)
+			expected *= i;
+
+		BigIntArena arena(4096);
+		BigInt heap_value = expected;
+		BigInt result;
+		for (int round = 0; round < 2; ++round)
+		{
+			BigInt f(1);  // outlives the scope so that it can be copied out
+			{
+				BigIntArenaScope scope(arena);
+				for (int i = 2; i <= 300; ++i)
+					f = f * i;
+				BigInt dropped(std::move(heap_value));  // a heap block freed while the arena is active
+			}
+			result = f;  // copy back to the global heap
+		}
+		arena.Reset();
+		cout << "300! computed in an arena";
+		print_test_result<BigInt>(result, expected);
+		cout << "arena allocations";
+		print_test_result<bool>(arena.GetStats().allocations > 0, true);
+		cout << "every arena block given back";
+		print_test_result<size_t>(arena.GetStats().deallocations, arena.GetStats().allocations);
+	}
+
+	cout << "testing modular exponentiation" << endl;
+	{
+		BigInt a("265613988875874769338781322035779626829233452653394495974574961739092490901302182994384699044008");
+		BigInt e("10000000000000000000000000000000000000123");
+		BigInt odd("1000000000000000000000000000000000000000000000000000000000033");
+		BigInt even("4820814132776970826625886277024487807566608981348378505904128");
+		cout << "PowMod, odd modulus";
+		print_test_result<BigInt>(BigInt::PowMod(a, e, odd), BigInt("877543552139938640056306290263407688342679564231563132992926"));
+		cout << "PowMod, even modulus";
+		print_test_result<BigInt>(BigInt::PowMod(a, e, even), BigInt("758725078755629495356311607574755582664083670277537801437184"));
+		cout << "PowMod, negative base";
+		print_test_result<BigInt>(BigInt::PowMod(-a, e, -odd), BigInt("122456447860061359943693709736592311657320435768436867007107"));
+		print_test_result<BigInt>(BigInt::PowMod(-a, e + 1, even), BigInt("4189584116253874545239029914664097718791516107478752036913152"));
+		cout << "PowMod, single limb moduli";
+		print_test_result<BigInt>(BigInt::PowMod(123456789, BigInt("1000000000000000000000000000000"), 97), 35);
+		print_test_result<BigInt>(BigInt::PowMod(-5, 3, 12), 7);
+		cout << "PowMod, small exponents and moduli";
+		print_test_result<BigInt>(BigInt::PowMod(2, 100, BigInt("4294967296")), 0);
+		print_test_result<BigInt>(BigInt::PowMod(a, 0, odd), 1);
+		print_test_result<BigInt>(BigInt::PowMod(a, e, 1), 0);
+		print_test_result<BigInt>(BigInt::PowMod(0, e, odd), 0);
+
+		// Fermat: a^(p - 1) == 1 mod p for the prime 2^127 - 1
+		BigInt p("170141183460469231731687303715884105727");
+		MontgomeryContext ctx(p);
+		cout << "MontgomeryContext reused";
+		bool fermat = true;
+		for (int i = 2; i < 20; ++i)
+			fermat = fermat && ctx.PowMod(BigInt(i) * a, p - 1) == 1;
+		print_test_result<bool>(fermat, true);
+		cout << "MontgomeryContext::MulMod";
+		print_test_result<BigInt>(ctx.MulMod(a, -e), (a * -e) % p + p);
+
+		// 2048-bit moduli against plain powering
+		BigInt big = BigInt::Pow(3, 1290);
+		for (int parity = 0; parity < 2; ++parity)
+		{
+			BigInt n = big + parity;
+			cout << "PowMod against Pow, " << n.GetNumLimbs() << " limbs, " << (parity ? "even" : "odd");
+			print_test_result<BigInt>(BigInt::PowMod(a, 300, n), BigInt::Pow(a, 300) % n);
+		}
+
+		cout << "PowMod by zero modulus throws";
+		bool thrown = false;
+		try
+		{
+			BigInt::PowMod(a, e, 0);
+		}
+		catch (const std::domain_error&)
+		{
+			thrown = true;
+		}
+		print_test_result<bool>(thrown, true);
+	}
+
+	cout << "testing gcd" << endl;
+	{
+		BigInt a("135001445826730067355264069093608288945339697048095785270221444176735294425030049367956696068242829105064982652751415758499737520387469779132635994900");
+		BigInt b("317235175975422485720813725194517548547156367263175372943275120367557489526927220295133100606583875510033596974668567029657148148804879046825276");
+		BigInt g("806298426614800963164623929332");
+		cout << "Gcd";
+		print_test_result<BigInt>(BigInt::Gcd(a, b), g);
+		print_test_result<BigInt>(BigInt::Gcd(-b, a), g);
+		print_test_result<BigInt>(BigInt::Gcd(-12, 18), 6);
+		print_test_result<BigInt>(BigInt::Gcd(0, -5), 5);
+		print_test_result<BigInt>(BigInt::Gcd(0, 0), 0);
+		print_test_result<BigInt>(BigInt::Gcd(BigInt("18446744073709551616"), BigInt("12884901888")), BigInt("4294967296"));
+
+		BigInt x, y;
+		cout << "ExtendedGcd";
+		print_test_result<BigInt>(BigInt::ExtendedGcd(a, -b, x, y), g);
+		print_test_result<BigInt>(a * x - b * y, g);
+		print_test_result<BigInt>(BigInt::ExtendedGcd(-7, 0, x, y), 7);
+		print_test_result<BigInt>(x, -1);
 
+		cout << "ModInverse";
+		print_test_result<BigInt>(BigInt::ModInverse(BigInt("12345678901234567890"), BigInt("1000000000000000000000000000057")),
+			BigInt("144958541975015589114052575232"));
+		print_test_result<BigInt>(BigInt::ModInverse(-3, 7), 2);
+		cout << "ModInverse of a non-invertible value throws";
+		bool thrown = false;
+		try
+		{
+			BigInt::ModInverse(a, b);
+		}
+		catch (const std::domain_error&)
+		{
+			thrown = true;
+		}
+		print_test_result<bool>(thrown, true);
+
+		// the half-GCD on small operands, against known factorizations
+		size_t saved = BigInt::Thresholds().gcd_hgcd;
+		BigInt::Thresholds().gcd_hgcd = 4;
+		BigInt p = BigInt::Pow(3, 2000) * BigInt::Pow(5, 700);
+		BigInt q = BigInt::Pow(3, 1500) * BigInt::Pow(7, 900);
+		cout << "half-GCD of " << p.GetNumLimbs() << " and " << q.GetNumLimbs() << " limbs";
+		print_test_result<BigInt>(BigInt::ExtendedGcd(p, q, x, y), BigInt::Pow(3, 1500));
+		print_test_result<BigInt>(p * x + q * y, BigInt::Pow(3, 1500));
+		BigInt f0 = 0, f1 = 1;
+		for (int i = 0; i < 5000; ++i)
+		{
+			f0 += f1;
+			std::swap(f0, f1);
+		}
+		cout << "half-GCD of consecutive Fibonacci numbers";
+		print_test_result<BigInt>(BigInt::Gcd(f1, f0), 1);
+		print_test_result<BigInt>(BigInt::ModInverse(f0, f1) * f0 % f1, 1);
+		BigInt::Thresholds().gcd_hgcd = saved;
+	}
+
+	cout << "testing roots" << endl;
+	{
+		BigInt a = BigInt::Pow(3, 301);
+		BigInt b = BigInt::Pow(7, 200) * 2 + 1;
+		cout << "ISqrt";
+		print_test_result<BigInt>(BigInt::ISqrt(a), BigInt("640838854296277144804798255578758614044317540884078525220657498333891458"));
+		print_test_result<BigInt>(BigInt::ISqrt(BigInt("18446744073709551615")), BigInt("4294967295"));
+		print_test_result<BigInt>(BigInt::ISqrt(0), 0);
+		cout << "IRoot";
+		print_test_result<BigInt>(BigInt::IRoot(b, 5), BigInt("7313539304141846216074591942805147"));
+		print_test_result<BigInt>(BigInt::IRoot(-b, 5), BigInt("-7313539304141846216074591942805147"));
+		print_test_result<BigInt>(BigInt::IRoot(BigInt::Pow(10, 3000), 1000), 1000);
+		print_test_result<BigInt>(BigInt::IRoot(BigInt::Pow(10, 3000) - 1, 1000), 999);
+		print_test_result<BigInt>(BigInt::IRoot(3, 200000000), 1);
+		print_test_result<BigInt>(BigInt::IRoot(BigInt::Pow(3, 5000), 5000), 3);
+		cout << "IsPerfectSquare";
+		print_test_result<bool>(BigInt::IsPerfectSquare(a * a), true);
+		print_test_result<bool>(BigInt::IsPerfectSquare(a * a + 1), false);
+		print_test_result<bool>(BigInt::IsPerfectSquare(a), false);
+		print_test_result<bool>(BigInt::IsPerfectSquare(-4), false);
+		cout << "IsPerfectPower";
+		print_test_result<bool>(BigInt::IsPerfectPower(a), true);
+		print_test_result<bool>(BigInt::IsPerfectPower(BigInt::Pow(b, 7)), true);
+		print_test_result<bool>(BigInt::IsPerfectPower(-BigInt::Pow(b, 9)), true);
+		print_test_result<bool>(BigInt::IsPerfectPower(-BigInt::Pow(b, 4)), false);
+		print_test_result<bool>(BigInt::IsPerfectPower(BigInt::Pow(b, 7) + 1), false);
+		print_test_result<bool>(BigInt::IsPerfectPower(BigInt::Pow(6, 35) * 8), false);
+		print_test_result<bool>(BigInt::IsPerfectPower(BigInt::Pow(65537, 97)), true);
+		print_test_result<bool>(BigInt::IsPerfectPower(BigInt::Pow(65537, 97) + 2), false);
+		print_test_result<bool>(BigInt::IsPerfectPower(BigInt::Pow(3, 1000) * BigInt::Pow(5, 500)), true);
+		print_test_result<bool>(BigInt::IsPerfectPower(-BigInt::Pow(2, 62)), true);
+		print_test_result<bool>(BigInt::IsPerfectPower(-BigInt::Pow(2, 64)), false);
+		cout << "even root of a negative value throws";
+		bool thrown = false;
+		try
+		{
+			BigInt::ISqrt(-1);
+		}
+		catch (const std::domain_error&)
+		{
+			thrown = true;
+		}
+		print_test_result<bool>(thrown, true);
+	}
+
+	cout << "testing factorials" << endl;
+	{
+		BigInt f = 1;
+		for (int i = 2; i <= 300; ++i)
+			f *= i;
+		cout << "Factorial";
+		print_test_result<BigInt>(BigInt::Factorial(0), 1);
+		print_test_result<BigInt>(BigInt::Factorial(20), BigInt("2432902008176640000"));
+		print_test_result<BigInt>(BigInt::Factorial(25), BigInt("15511210043330985984000000"));
+		print_test_result<BigInt>(BigInt::Factorial(300), f);
+		cout << "Binomial";
+		print_test_result<BigInt>(BigInt::Binomial(100, 50), BigInt("100891344545564193334812497256"));
+		print_test_result<BigInt>(BigInt::Binomial(600, 300), BigInt::Factorial(600) / (BigInt::Factorial(300) * BigInt::Factorial(300)));
+		print_test_result<BigInt>(BigInt::Binomial(7, 0), 1);
+		print_test_result<BigInt>(BigInt::Binomial(5, 7), 0);
+		cout << "Primorial";
+		print_test_result<BigInt>(BigInt::Primorial(1), 1);
+		print_test_result<BigInt>(BigInt::Primorial(30), BigInt("6469693230"));
+	}
+
+	cout << "testing single-word operands" << endl;
+	{
+		BigInt a("-123456789012345678901234567890");
+		cout << "construction";
+		print_test_result<BigInt>(BigInt(INT64_MIN), BigInt("-9223372036854775808"));
+		print_test_result<BigInt>(BigInt(UINT64_MAX), BigInt("18446744073709551615"));
+		cout << "arithmetic";
+		print_test_result<BigInt>(a + 1, a + BigInt(1));
+		print_test_result<BigInt>(a - UINT64_MAX, a - BigInt("18446744073709551615"));
+		print_test_result<BigInt>(7 - a, BigInt(7) - a);
+		print_test_result<BigInt>(a * INT64_MIN, a * BigInt("-9223372036854775808"));
+		print_test_result<BigInt>(a / 1000000007, a / BigInt(1000000007));
+		print_test_result<BigInt>(a % 1000000007, a % BigInt(1000000007));
+		print_test_result<BigInt>(a / -10000000000LL, a / BigInt("-10000000000"));
+		print_test_result<BigInt>(a % -10000000000LL, a % BigInt("-10000000000"));
+		print_test_result<BigInt>(BigInt(UINT64_MAX) + 1u, BigInt("18446744073709551616"));
+		BigInt c("340282366920938463463374607431768211455");  // 2^128 - 1, the largest inline value
+		print_test_result<BigInt>(c + 1u, BigInt("340282366920938463463374607431768211456"));
+		print_test_result<BigInt>(c / UINT64_MAX, BigInt("18446744073709551617"));
+		print_test_result<BigInt>(c % UINT64_MAX, BigInt(0));
+		cout << "comparison";
+		print_test_result<bool>(a < 0, true);
+		print_test_result<bool>(0 > a, true);
+		print_test_result<bool>(BigInt(-5) == -5L, true);
+		print_test_result<bool>(BigInt(UINT64_MAX) != UINT64_MAX, false);
+		print_test_result<bool>(BigInt("18446744073709551616") > UINT64_MAX, true);
+	}
+
+	cout << "testing three-way comparison" << endl;
+	{
+		BigInt a("123456789012345678901234567890");
+		BigInt b = a + 1;
+		cout << "Compare";
+		print_test_result<int>(BigInt::Compare(a, b), -1);
+		print_test_result<int>(BigInt::Compare(b, a), 1);
+		print_test_result<int>(BigInt::Compare(-a, -b), 1);
+		print_test_result<int>(BigInt::Compare(-a, a), -1);
+		print_test_result<int>(BigInt::Compare(a, BigInt(a)), 0);
+		print_test_result<int>(BigInt::Compare(BigInt("-0"), BigInt(0)), 0);
+		cout << "equality";
+		print_test_result<bool>(a == BigInt(a), true);
+		print_test_result<bool>(a == -a, false);
+		print_test_result<bool>(a == b, false);
+		print_test_result<bool>(BigInt("-0") == BigInt("0"), true);
+#ifdef BIGINT_THREE_WAY_COMPARISON
+		cout << "operator<=>";
+		print_test_result<bool>((a <=> b) == std::strong_ordering::less, true);
+		print_test_result<bool>((-a <=> -b) == std::strong_ordering::greater, true);
+		print_test_result<bool>((a <=> 5) == std::strong_ordering::greater, true);
+#endif
+	}
+
+	cout << "testing bitwise operations" << endl;
+	{
+		BigInt a("123456789012345678901234567890");
+		BigInt b("-98765432109876543210");
+		cout << "and, or, xor, not";
+		print_test_result<BigInt>(a & b, BigInt("123456788933793542183975452690"));
+		print_test_result<BigInt>(a | b, BigInt("-20213295392617428010"));
+		print_test_result<BigInt>(a ^ b, BigInt("-123456788954006837576592880700"));
+		print_test_result<BigInt>(~a, -a - 1);
+		print_test_result<BigInt>(BigInt(-1) & a, a);
+		print_test_result<BigInt>(a ^ a, 0);
+		cout << "shifts";
+		print_test_result<BigInt>(a << 100, a * BigInt::Pow(2, 100));
+		print_test_result<BigInt>(a >> 33, a / BigInt::Pow(2, 33));
+		print_test_result<BigInt>(BigInt(-5) >> 1, -3);
+		print_test_result<BigInt>(b >> 1000, -1);
+		print_test_result<BigInt>(-BigInt::Pow(2, 64) >> 64, -1);
+		cout << "bit queries";
+		print_test_result<size_t>(a.BitLength(), 97);
+		print_test_result<size_t>(BigInt(0).BitLength(), 0);
+		print_test_result<bool>(a.TestBit(1), true);
+		print_test_result<bool>(a.TestBit(0), false);
+		print_test_result<bool>(BigInt(-2).TestBit(0), false);
+		print_test_result<bool>(BigInt(-2).TestBit(5000), true);
+		print_test_result<size_t>(a.PopCount(), 54);
+		print_test_result<size_t>((-a).TrailingZeros(), 1);
+		print_test_result<size_t>((BigInt(3) << 200).TrailingZeros(), 200);
+	}
+
+	cout << "testing serialization" << endl;
+	{
+		BigInt values[] = { 0, 1, -1, BigInt("-18446744073709551616"), BigInt::Pow(3, 1000), -BigInt::Pow(7, 5000) };
+		std::vector<uint8_t> buffer;
+		cout << "round trip";
+		for (const BigInt& x : values)
+		{
+			std::vector<uint8_t> bytes = x.Serialize();
+			print_test_result<size_t>(bytes.size(), x.GetSerializedSize());
+			print_test_result<BigInt>(BigInt::Deserialize(bytes.data(), bytes.size()), x);
+			buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+		}
+		cout << "format";
+		std::vector<uint8_t> minus_2_32 = { 5, 0, 0, 0, 0, 1, 0, 0, 0 };
+		print_test_result<bool>(BigInt(-4294967296LL).Serialize() == minus_2_32, true);
+		cout << "views over one buffer";
+		std::vector<BigIntView> views;
+		size_t offset = 0;
+		for (const BigInt& x : values)
+		{
+			views.emplace_back(buffer.data() + offset, buffer.size() - offset);
+			print_test_result<bool>(views.back() == x, true);
+			print_test_result<size_t>(views.back().BitLength(), x.BitLength());
+			print_test_result<bool>(views.back().TestBit(40), x.TestBit(40));
+			offset += views.back().GetSerializedSize();
+		}
+		print_test_result<size_t>(offset, buffer.size());
+		print_test_result<BigInt>(views[4].ToBigInt(), values[4]);
+		print_test_result<bool>(views[0] < views[4], true);
+		print_test_result<bool>(views[5] < views[2], true);
+		print_test_result<int>(BigIntView::Compare(views[4], values[4] + 1), -1);
+		cout << "malformed input throws";
+		std::vector<std::vector<uint8_t>> malformed = { {}, { 0x80 }, { 1 }, { 2, 1, 2, 3 }, { 2, 0, 0, 0, 0 }, { 0x80, 0 },
+			{ 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f } };
+		for (const std::vector<uint8_t>& bytes : malformed)
+		{
+			bool thrown = false;
+			try
+			{
+				BigInt::Deserialize(bytes.data(), bytes.size());
+			}
+			catch (const std::invalid_argument&)
+			{
+				thrown = true;
+			}
+			print_test_result<bool>(thrown, true);
+		}
+	}
+
+	cout << "testing streaming conversion" << endl;
+	{
+		// several parsing blocks, a partial one and a leading zero
+		std::string text = "0" + BigInt::Pow(7, 60000).GetViewStr();
+		BigInt expected(text);
+		std::istringstream in("  -" + text + " 12x");
+		BigInt a, b;
+		in >> a >> b;
+		cout << "operator>>";
+		print_test_result<BigInt>(a, -expected);
+		print_test_result<BigInt>(b, 12);
+		print_test_result<bool>(in.good(), true);
+		in >> b;
+		print_test_result<bool>(in.fail(), true);
+		print_test_result<BigInt>(b, 12);
+		cout << "operator<< and BigIntNoParens";
+		std::ostringstream out;
+		out << BigInt(-5) << BigIntNoParens << BigInt(-5) << " " << a << BigIntParens << BigInt(7);
+		print_test_result<bool>(out.str() == "(-5)-5 " + a.GetViewStr() + "(7)", true);
+		cout << "WriteDecimal";
+		std::string written;
+		a.WriteDecimal([&written](const char* chars, size_t n) { written.append(chars, n); });
+		print_test_result<bool>(written == a.GetViewStr(), true);
+		cout << "character range";
+		print_test_result<BigInt>(BigInt(text.data(), text.size()), expected);
+		print_test_result<BigInt>(BigInt("+12345", 3), 12);
+	}
+
+	cout << "testing ToChars/FromChars" << endl;
+	{
+		auto to_chars = [](const BigInt& x, int base)
+		{
+			std::vector<char> buffer(x.DigitCountUpperBound(base));
+			std::to_chars_result result = x.ToChars(buffer.data(), buffer.data() + buffer.size(), base);
+			return (result.ec == std::errc()) ? std::string(buffer.data(), result.ptr) : std::string("error");
+		};
+		cout << "ToChars";
+		print_test_result<std::string>(to_chars(BigInt(0), 2), "0");
+		print_test_result<std::string>(to_chars(BigInt(-255), 16), "-ff");
+		print_test_result<std::string>(to_chars(BigInt(-255), 2), "-11111111");
+		print_test_result<std::string>(to_chars(BigInt(UINT64_MAX), 36), "3w5e11264sgsf");
+		print_test_result<std::string>(to_chars(BigInt::Pow(3, 100), 36), "ajmfwc7pep3zss2fwkm9zm45pd86w29");
+		BigInt big = BigInt::Pow(7, 3000);  // past the stack and divide-and-conquer limits
+		print_test_result<std::string>(to_chars(big, 7), "1" + std::string(3000, '0'));
+		print_test_result<std::string>(to_chars(big, 10), big.GetViewStr());
+		char small[4];
+		std::to_chars_result too_small = BigInt(-1000).ToChars(small, small + 4, 10);
+		print_test_result<bool>(too_small.ec == std::errc::value_too_large && too_small.ptr == small + 4, true);
+		too_small = big.ToChars(small, small + 4, 10);
+		print_test_result<bool>(too_small.ec == std::errc::value_too_large, true);
+
+		cout << "FromChars";
+		BigInt x = 5;
+		std::string text = "-FfFf0123456789abcdefghij!";
+		std::from_chars_result parsed = BigInt::FromChars(text.data(), text.data() + text.size(), x, 16);
+		print_test_result<bool>(parsed.ec == std::errc() && parsed.ptr == text.data() + 21, true);
+		print_test_result<BigInt>(x, -BigInt("1208907454856084681641455"));
+		parsed = BigInt::FromChars(text.data(), text.data() + text.size(), x, 10);
+		print_test_result<bool>(parsed.ec == std::errc::invalid_argument && parsed.ptr == text.data(), true);
+		print_test_result<BigInt>(x, -BigInt("1208907454856084681641455"));
+		text = "-0";
+		BigInt::FromChars(text.data(), text.data() + text.size(), x, 3);
+		print_test_result<bool>(x == 0 && !x.GetSign(), true);
+		for (int base : { 2, 3, 10, 16, 36 })
+		{
+			std::string digits = to_chars(-big, base);
+			BigInt::FromChars(digits.data(), digits.data() + digits.size(), x, base);
+			print_test_result<BigInt>(x, -big);
+		}
+
+		cout << "DigitCountUpperBound";
+		print_test_result<size_t>(BigInt(0).DigitCountUpperBound(16), 1);
+		print_test_result<size_t>(BigInt(-256).DigitCountUpperBound(16), 4);
+		print_test_result<bool>(big.DigitCountUpperBound(10) >= big.GetViewStr().size(), true);
+		print_test_result<bool>(big.DigitCountUpperBound(10) <= big.GetViewStr().size() + 2, true);
+	}
+
+	cout << "testing expression templates" << endl;
+	{
+		BigInt a = BigInt::Pow(3, 200);
+		BigInt b = -BigInt::Pow(7, 90);
+		BigInt c = BigInt::Pow(5, 150) + 1;
+		BigInt d("4294967291");
+		BigInt e = -BigInt::Pow(2, 300);
+		cout << "AddMul/SubMul";
+		// every sign combination, with single-limb factors, and x shorter and longer than the product
+		bool all_equal = true;
+		for (const BigInt& x0 : { BigInt(0), BigInt(5), BigInt(-5), a, -a, a * a, -(a * a), a * d + 1 })
+		{
+			for (const BigInt& f : { b, -b, d, -d, BigInt(1) })
+			{
+				BigInt x = x0;
+				x.AddMul(a, f);
+				all_equal = all_equal && (x == x0 + a * f);
+				x = x0;
+				x.SubMul(f, a);
+				all_equal = all_equal && (x == x0 - a * f);
+			}
+		}
+		print_test_result<bool>(all_equal, true);
+		BigInt x = a;
+		x.AddMul(x, x);
+		print_test_result<BigInt>(x, a + a * a);
+		x.SubMul(x, d);
+		print_test_result<BigInt>(x, (a + a * a) * (1 - d));
+
+		cout << "evaluation";
+		BigInt r = 12345;
+		r = BigIntLazy(a) * b + BigIntLazy(c) * d - e;
+		print_test_result<BigInt>(r, a * b + c * d - e);
+		r = -(BigIntLazy(a) - b) * (c + BigIntLazy(e)) + 7 * BigIntLazy(d) - 3;
+		print_test_result<BigInt>(r, -(a - b) * (c + e) + 7 * d - 3);
+		BigInt constructed = BigIntLazy(a) * a - 1;
+		print_test_result<BigInt>(constructed, a * a - 1);
+		print_test_result<BigInt>((BigIntLazy(a) + 1) / 2, (a + 1) / 2);
+
+		cout << "operands aliasing the result";
+		x = a;
+		x = BigIntLazy(x) * b + x;
+		print_test_result<BigInt>(x, a * b + a);
+		x = a;
+		x = c - BigIntLazy(x) * x;
+		print_test_result<BigInt>(x, c - a * a);
+		x = a;
+		x = (BigIntLazy(x) + 1) * (BigIntLazy(x) - 1);
+		print_test_result<BigInt>(x, (a + 1) * (a - 1));
+		x = a;
+		x += BigIntLazy(c) * d;
+		print_test_result<BigInt>(x, a + c * d);
+		x -= BigIntLazy(x) * d;
+		print_test_result<BigInt>(x, (a + c * d) * (1 - d));
+
+		cout << "Horner evaluation";
+		BigInt lazy = 0;
+		BigInt eager = 0;
+		for (int i = 0; i < 50; ++i)
+		{
+			BigInt coefficient = (i % 3 == 0) ? -a : c + i;
+			lazy = BigIntLazy(lazy) * 1000003 + coefficient;
+			eager = eager * 1000003 + coefficient;
+		}
+		print_test_result<BigInt>(lazy, eager);
+	}
+
+	cout << "testing FixedInt" << endl;
+	{
+		typedef FixedInt<256> Int256;
+		// evaluated by the compiler
+		constexpr Int256 f = [] { Int256 r = 1; for (int i = 2; i <= 50; ++i) r *= i; return r; }();  // 50! < 2^215
+		static_assert(f % 1000000007 == 318608048, "constexpr FixedInt arithmetic");
+		static_assert(Int256(-7) / 2 == -3 && Int256(-7) % 2 == -1, "division truncates toward zero");
+		static_assert((Int256(1) << 255) < 0 && (Int256(1) << 255) - 1 > 0, "wraps modulo 2^256");
+		cout << "conversion";
+		BigInt big_f = BigInt::Factorial(50);
+		print_test_result<BigInt>(f.ToBigInt(), big_f);
+		print_test_result<BigInt>(Int256(-big_f).ToBigInt(), -big_f);
+		BigInt min = -(BigInt(1) << 255);
+		print_test_result<BigInt>(Int256(min).ToBigInt(), min);
+		print_test_result<bool>(Int256::Fits(min) && !Int256::Fits(min - 1) && !Int256::Fits(-min), true);
+		bool thrown = false;
+		try
+		{
+			Int256 x(-min);
+		}
+		catch (const std::invalid_argument&)
+		{
+			thrown = true;
+		}
+		print_test_result<bool>(thrown, true);
+		cout << "arithmetic";
+		Int256 a(BigInt("-9876543210987654321098765432109876543210"));  // a * b fits
+		Int256 b(BigInt("12345678901234567890123456789"));
+		BigInt big_a = a.ToBigInt();
+		BigInt big_b = b.ToBigInt();
+		print_test_result<BigInt>((a + b).ToBigInt(), big_a + big_b);
+		print_test_result<BigInt>((a - b).ToBigInt(), big_a - big_b);
+		print_test_result<BigInt>((a * b).ToBigInt(), big_a * big_b);
+		print_test_result<BigInt>((a / b).ToBigInt(), big_a / big_b);
+		print_test_result<BigInt>((a % b).ToBigInt(), big_a % big_b);
+		print_test_result<BigInt>((a / -3).ToBigInt(), big_a / -3);
+		print_test_result<BigInt>((a >> 70).ToBigInt(), big_a >> 70);
+		print_test_result<BigInt>((a ^ b).ToBigInt(), big_a ^ big_b);
+		// wrapping: (2^255 - 1) * 3 == 2^255 - 3 mod 2^256, and -(-2^255) == -2^255
+		Int256 max(-min - 1);
+		print_test_result<BigInt>((max * 3).ToBigInt(), -min - 3);
+		print_test_result<bool>(max + 1 == Int256(min) && -Int256(min) == Int256(min), true);
+		print_test_result<bool>(Int256(min) / -1 == Int256(min), true);
+		cout << "Abs, Negate, comparison, GetViewStr";
+		Int256 c = a;
+		c.Negate();
+		print_test_result<bool>(c == a.Abs() && c > b && a < b && Int256::Compare(a, a) == 0, true);
+		print_test_result<std::string>(a.GetViewStr(), big_a.GetViewStr());
+	}
 
 	cout << "testing unary minus" << endl;
 	cout << -(-BigInt("5")) << endl;